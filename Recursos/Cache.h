@@ -0,0 +1,262 @@
+/**
+ * @author Fernández Nicolás (nicofernandez@alumnos.unc.edu.ar)
+ * @date Mayo, 2017
+ * @version 0.5.2017 beta
+ *
+ * @brief Cache de respuestas por clave (cadena) con un presupuesto de
+ * bytes: al superarlo se descartan las menos usadas recientemente
+ * (LRU). Cada respuesta lleva la versión de los datos con que se
+ * calculó y solo se devuelve mientras esa versión siga vigente
+ *
+ * \file Cache.h
+ */
+
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include "Mem.h"
+
+///Casillas de la tabla de búsqueda (potencia de 2)
+#define CACHE_CASILLAS 1024
+
+typedef struct cache_entrada {
+	
+	char * clave;
+	char * valor;
+	size_t largo; /// del valor, sin el '\0'
+	size_t bytes; /// que descuenta del presupuesto
+	long unsigned int version;
+	uint64_t hash;
+	struct cache_entrada * anterior; /// más reciente
+	struct cache_entrada * siguiente; /// menos reciente
+	struct cache_entrada * proxima; /// en la misma casilla
+	
+} cache_entrada;
+
+typedef struct {
+	
+	cache_entrada * casillas[CACHE_CASILLAS];
+	cache_entrada * primera; /// la usada más recientemente
+	cache_entrada * ultima;
+	size_t bytes;
+	size_t presupuesto;
+	unsigned int cant;
+	long unsigned int aciertos;
+	long unsigned int fallos;
+	
+} cache;
+
+/**
+ * @brief Hash FNV-1a de 64 bits
+ */
+uint64_t Cache_Hash( const char * clave )
+{
+	
+	uint64_t hash = 14695981039346656037ULL;
+	while( *clave != '\0' )
+	{
+		
+		hash ^= (unsigned char)*clave++;
+		hash *= 1099511628211ULL;
+		
+	}
+	
+	return hash;
+	
+}
+
+void Cache_Iniciar( cache * c , size_t presupuesto )
+{
+	
+	memset( c , 0 , sizeof( cache ) );
+	c->presupuesto = presupuesto;
+	
+}
+
+///Saca la entrada de la lista de uso (sigue en su casilla)
+void Cache_Desenlazar( cache * c , cache_entrada * e )
+{
+	
+	if( e->anterior != NULL )
+		e->anterior->siguiente = e->siguiente;
+	else
+		c->primera = e->siguiente;
+	if( e->siguiente != NULL )
+		e->siguiente->anterior = e->anterior;
+	else
+		c->ultima = e->anterior;
+	
+}
+
+///Pone la entrada primera en la lista de uso
+void Cache_Enlazar( cache * c , cache_entrada * e )
+{
+	
+	e->anterior = NULL;
+	e->siguiente = c->primera;
+	if( c->primera != NULL )
+		c->primera->anterior = e;
+	else
+		c->ultima = e;
+	c->primera = e;
+	
+}
+
+void Cache_Eliminar_entrada( cache * c , cache_entrada * e )
+{
+	
+	cache_entrada ** enlace = &c->casillas[e->hash &
+										   ( CACHE_CASILLAS - 1 )];
+	while( *enlace != e )
+		enlace = &( *enlace )->proxima;
+	*enlace = e->proxima;
+	Cache_Desenlazar( c , e );
+	
+	c->bytes -= e->bytes;
+	c->cant--;
+	Mem_desassign( (void **)&e->clave );
+	Mem_desassign( (void **)&e->valor );
+	Mem_desassign( (void **)&e );
+	
+}
+
+cache_entrada * Cache_Entrada( cache * c , const char * clave ,
+							   uint64_t hash )
+{
+	
+	cache_entrada * e = c->casillas[hash & ( CACHE_CASILLAS - 1 )];
+	while( e != NULL &&
+		   ( e->hash != hash || strcmp( e->clave , clave ) != 0 ) )
+		e = e->proxima;
+	
+	return e;
+	
+}
+
+/**
+ * @brief Busca la respuesta de 'clave' calculada con 'version'; una
+ * de otra versión ya no sirve y se descarta
+ *
+ * @return entrada (la más reciente desde ahora) o NULL si no está
+ */
+cache_entrada * Cache_Vigente( cache * c , const char * clave ,
+							   long unsigned int version )
+{
+	
+	uint64_t hash = Cache_Hash( clave );
+	cache_entrada * e = Cache_Entrada( c , clave , hash );
+	if( e != NULL && e->version != version )
+	{
+		
+		Cache_Eliminar_entrada( c , e );
+		e = NULL;
+		
+	}
+	if( e == NULL )
+	{
+		
+		c->fallos++;
+		return NULL;
+		
+	}
+	
+	c->aciertos++;
+	Cache_Desenlazar( c , e );
+	Cache_Enlazar( c , e );
+	
+	return e;
+	
+}
+
+/**
+ * @return copia de la respuesta o NULL si no está (Cache_Vigente)
+ */
+char * Cache_Buscar_FREE( cache * c , const char * clave ,
+						  long unsigned int version )
+{
+	
+	cache_entrada * e = Cache_Vigente( c , clave , version );
+		if( e == NULL )
+			return NULL;
+	
+	char * copia = Mem_assign( e->largo + 1 );
+	memcpy( copia , e->valor , e->largo + 1 );
+	
+	return copia;
+	
+}
+
+/**
+ * @return copia de la respuesta en el área o NULL si no está
+ */
+char * Cache_Buscar_en( cache * c , const char * clave ,
+						long unsigned int version , arena * area )
+{
+	
+	cache_entrada * e = Cache_Vigente( c , clave , version );
+		if( e == NULL )
+			return NULL;
+	
+	char * copia = Mem_Arena_assign( area , e->largo + 1 );
+	memcpy( copia , e->valor , e->largo + 1 );
+	
+	return copia;
+	
+}
+
+/**
+ * @brief Guarda una copia de la respuesta de 'clave' y descarta las
+ * menos usadas hasta volver al presupuesto. Una respuesta de más de un
+ * cuarto del presupuesto no se guarda: desplazaría a muchas otras
+ */
+void Cache_Guardar( cache * c , const char * clave ,
+					const char * valor , long unsigned int version )
+{
+	
+	size_t largo_clave = strlen( clave );
+	size_t largo = strlen( valor );
+	size_t bytes = sizeof( cache_entrada ) + largo_clave + largo + 2;
+		if( bytes > c->presupuesto / 4 )
+			return;
+	
+	uint64_t hash = Cache_Hash( clave );
+	cache_entrada * e = Cache_Entrada( c , clave , hash );
+	if( e != NULL )
+		Cache_Eliminar_entrada( c , e );
+	
+	e = Mem_assign( sizeof( cache_entrada ) );
+	e->clave = Mem_assign( largo_clave + 1 );
+	memcpy( e->clave , clave , largo_clave + 1 );
+	e->valor = Mem_assign( largo + 1 );
+	memcpy( e->valor , valor , largo + 1 );
+	e->largo = largo;
+	e->bytes = bytes;
+	e->version = version;
+	e->hash = hash;
+	
+	cache_entrada ** casilla = &c->casillas[hash &
+											( CACHE_CASILLAS - 1 )];
+	e->proxima = *casilla;
+	*casilla = e;
+	Cache_Enlazar( c , e );
+	c->bytes += bytes;
+	c->cant++;
+	
+	while( c->bytes > c->presupuesto )
+		Cache_Eliminar_entrada( c , c->ultima );
+	
+}
+
+///Descarta todas las respuestas (el presupuesto se mantiene)
+void Cache_Vaciar( cache * c )
+{
+	
+	while( c->ultima != NULL )
+		Cache_Eliminar_entrada( c , c->ultima );
+	
+}
+
+#endif
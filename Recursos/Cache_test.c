@@ -0,0 +1,107 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>		/* rand */
+
+#include "Cache.h"
+
+#define CLAVES 300
+
+int main()
+{
+	
+	unsigned int errores = 0;
+	cache c;
+	Cache_Iniciar( &c , 4096 );
+	
+	///Una respuesta de otra versión no sirve
+	char * valor;
+	Cache_Guardar( &c , "listar" , "a" , 1 );
+	valor = Cache_Buscar_FREE( &c , "listar" , 1 );
+	if( valor == NULL || strcmp( valor , "a" ) != 0 )
+		errores++;
+	Mem_desassign( (void **)&valor );
+	if( Cache_Buscar_FREE( &c , "listar" , 2 ) != NULL || c.cant != 0 )
+		errores++;
+	
+	///La menos usada sale primero
+	char clave[32];
+	char texto[512];
+	memset( texto , 'x' , 400 );
+	texto[400] = '\0';
+	unsigned int pos;
+	for( pos = 0 ; pos < 20 ; pos++ )
+	{
+		
+		snprintf( clave , sizeof( clave ) , "clave %u" , pos );
+		Cache_Guardar( &c , clave , texto , 1 );
+		///La primera se sigue usando: nunca es la menos reciente
+		valor = Cache_Buscar_FREE( &c , "clave 0" , 1 );
+		if( valor == NULL )
+			errores++;
+		Mem_desassign( (void **)&valor );
+		
+	}
+	if( c.bytes > c.presupuesto ||
+		Cache_Buscar_FREE( &c , "clave 1" , 1 ) != NULL )
+		errores++;
+	arena * area = Mem_Arena_create( 256 );
+	valor = Cache_Buscar_en( &c , "clave 19" , 1 , area );
+	if( valor == NULL || strcmp( valor , texto ) != 0 )
+		errores++;
+	Mem_Arena_delete( &area );
+	
+	///Demasiado grande para guardar
+	memset( texto , 'y' , 511 );
+	texto[511] = '\0';
+	Cache_Vaciar( &c );
+	Cache_Iniciar( &c , 1024 );
+	Cache_Guardar( &c , "grande" , texto , 1 );
+	if( c.cant != 0 )
+		errores++;
+	
+	///Al azar: lo que se encuentra es lo último guardado
+	unsigned int guardado[CLAVES];
+	memset( guardado , 0 , sizeof( guardado ) );
+	Cache_Vaciar( &c );
+	Cache_Iniciar( &c , 1 << 16 );
+	unsigned int prueba;
+	for( prueba = 1 ; prueba < 200000 ; prueba++ )
+	{
+		
+		unsigned int k = rand() % CLAVES;
+		long unsigned int version = prueba / 50000;
+		snprintf( clave , sizeof( clave ) , "k%u" , k );
+		if( rand() % 3 == 0 )
+		{
+			
+			snprintf( texto , sizeof( texto ) , "%u %*s" , prueba ,
+					  rand() % 300 , "" );
+			Cache_Guardar( &c , clave , texto , version );
+			guardado[k] = prueba;
+			continue;
+			
+		}
+		
+		valor = Cache_Buscar_FREE( &c , clave , version );
+		if( valor != NULL && ( (unsigned int)atoi( valor ) !=
+							   guardado[k] ||
+							   guardado[k] / 50000 != version ) )
+			errores++;
+		Mem_desassign( (void **)&valor );
+		if( c.bytes > c.presupuesto )
+			errores++;
+		
+	}
+	if( c.aciertos == 0 || c.fallos == 0 )
+		errores++;
+	Cache_Vaciar( &c );
+	if( c.cant != 0 || c.bytes != 0 || c.primera != NULL )
+		errores++;
+	
+	printf( "\n aciertos = %lu , fallos = %lu" ,
+			c.aciertos , c.fallos );
+	printf( "\n errores = %u\n" , errores );
+	
+	return errores != 0;
+	
+}
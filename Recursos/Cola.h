@@ -0,0 +1,167 @@
+/**
+ * @author Fernández Nicolás (nicofernandez@alumnos.unc.edu.ar)
+ * @date Mayo, 2017
+ * @version 0.5.2017 beta
+ *
+ * @brief Cola acotada para pasar trabajo entre hilos (pthreads,
+ * compilar con -pthread): quien pone espera si está llena (salvo con
+ * Cola_Intentar_poner) y quien saca espera si está vacía. Los elementos
+ * se copian, de cualquier tamaño fijo
+ *
+ * \file Cola.h
+ */
+
+#ifndef COLA_H
+#define COLA_H
+
+#include <pthread.h>
+#include <string.h>
+
+#include "Mem.h"
+
+typedef struct {
+	
+	char * elementos;
+	size_t tam_elemento;
+	unsigned int capacidad;
+	unsigned int primero; /// el próximo a sacar
+	unsigned int cant;
+	int cerrada; /// ya no se puede poner; se saca lo que queda
+	pthread_mutex_t cerrojo;
+	pthread_cond_t hay_lugar;
+	pthread_cond_t hay_elementos;
+	
+} cola;
+
+void Cola_Iniciar( cola * c , unsigned int capacidad ,
+				   size_t tam_elemento )
+{
+	
+	c->elementos = Mem_assign_vector( capacidad , tam_elemento );
+	c->tam_elemento = tam_elemento;
+	c->capacidad = capacidad;
+	c->primero = 0;
+	c->cant = 0;
+	c->cerrada = 0;
+	pthread_mutex_init( &c->cerrojo , NULL );
+	pthread_cond_init( &c->hay_lugar , NULL );
+	pthread_cond_init( &c->hay_elementos , NULL );
+	
+}
+
+///Pone una copia del elemento al final; con el cerrojo tomado y lugar
+void Cola_Agregar( cola * c , const void * elemento )
+{
+	
+	unsigned int pos = ( c->primero + c->cant ) % c->capacidad;
+	memcpy( c->elementos + pos * c->tam_elemento , elemento ,
+			c->tam_elemento );
+	c->cant++;
+	pthread_cond_signal( &c->hay_elementos );
+	
+}
+
+/**
+ * @brief Pone una copia del elemento al final, esperando lugar
+ *
+ * @return 1 o 0 si la cola está cerrada
+ */
+int Cola_Poner( cola * c , const void * elemento )
+{
+	
+	pthread_mutex_lock( &c->cerrojo );
+	while( c->cant == c->capacidad && !c->cerrada )
+		pthread_cond_wait( &c->hay_lugar , &c->cerrojo );
+	if( c->cerrada )
+	{
+		
+		pthread_mutex_unlock( &c->cerrojo );
+		return 0;
+		
+	}
+	
+	Cola_Agregar( c , elemento );
+	pthread_mutex_unlock( &c->cerrojo );
+	
+	return 1;
+	
+}
+
+/**
+ * @brief Pone una copia del elemento al final solo si hay lugar, sin
+ * esperar
+ *
+ * @return 1, 0 si la cola está llena o -1 si está cerrada
+ */
+int Cola_Intentar_poner( cola * c , const void * elemento )
+{
+	
+	pthread_mutex_lock( &c->cerrojo );
+	int puesto = 1;
+	if( c->cerrada )
+		puesto = -1;
+	else if( c->cant == c->capacidad )
+		puesto = 0;
+	else
+		Cola_Agregar( c , elemento );
+	pthread_mutex_unlock( &c->cerrojo );
+	
+	return puesto;
+	
+}
+
+/**
+ * @brief Saca el primer elemento y lo copia en 'elemento', esperando
+ * que haya uno
+ *
+ * @return 1 o 0 si la cola está cerrada y vacía
+ */
+int Cola_Sacar( cola * c , void * elemento )
+{
+	
+	pthread_mutex_lock( &c->cerrojo );
+	while( c->cant == 0 && !c->cerrada )
+		pthread_cond_wait( &c->hay_elementos , &c->cerrojo );
+	if( c->cant == 0 )
+	{
+		
+		pthread_mutex_unlock( &c->cerrojo );
+		return 0;
+		
+	}
+	
+	memcpy( elemento , c->elementos + c->primero * c->tam_elemento ,
+			c->tam_elemento );
+	c->primero = ( c->primero + 1 ) % c->capacidad;
+	c->cant--;
+	pthread_cond_signal( &c->hay_lugar );
+	pthread_mutex_unlock( &c->cerrojo );
+	
+	return 1;
+	
+}
+
+///Despierta a todos los que esperan: ya no se pone nada más
+void Cola_Cerrar( cola * c )
+{
+	
+	pthread_mutex_lock( &c->cerrojo );
+	c->cerrada = 1;
+	pthread_cond_broadcast( &c->hay_lugar );
+	pthread_cond_broadcast( &c->hay_elementos );
+	pthread_mutex_unlock( &c->cerrojo );
+	
+}
+
+///Nadie debe estar usándola
+void Cola_Liberar( cola * c )
+{
+	
+	Mem_desassign( (void **)&c->elementos );
+	pthread_mutex_destroy( &c->cerrojo );
+	pthread_cond_destroy( &c->hay_lugar );
+	pthread_cond_destroy( &c->hay_elementos );
+	
+}
+
+#endif
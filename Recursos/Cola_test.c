@@ -0,0 +1,129 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "Cola.h"
+
+#define PRODUCTORES 4
+#define CONSUMIDORES 3
+#define POR_PRODUCTOR 100000
+#define CAPACIDAD 8
+
+typedef struct {
+	
+	unsigned int productor;
+	unsigned int numero;
+	
+} elemento;
+
+cola c;
+pthread_mutex_t cerrojo = PTHREAD_MUTEX_INITIALIZER;
+unsigned int recibidos[PRODUCTORES];
+unsigned int desordenados = 0;
+
+void * Producir( void * argumento )
+{
+	
+	elemento e;
+	e.productor = *(unsigned int *)argumento;
+	for( e.numero = 0 ; e.numero < POR_PRODUCTOR ; e.numero++ )
+		Cola_Poner( &c , &e );
+	
+	return NULL;
+	
+}
+
+void * Consumir( void * argumento )
+{
+	
+	(void)argumento;
+	elemento e;
+	unsigned int ultimo[PRODUCTORES];
+	memset( ultimo , 0 , sizeof( ultimo ) );
+	unsigned int cuenta[PRODUCTORES];
+	memset( cuenta , 0 , sizeof( cuenta ) );
+	unsigned int fuera_de_orden = 0;
+	while( Cola_Sacar( &c , &e ) )
+	{
+		
+		///De un mismo productor, cada consumidor los ve en orden
+		if( cuenta[e.productor] > 0 && e.numero <= ultimo[e.productor] )
+			fuera_de_orden++;
+		ultimo[e.productor] = e.numero;
+		cuenta[e.productor]++;
+		
+	}
+	
+	pthread_mutex_lock( &cerrojo );
+	desordenados += fuera_de_orden;
+	unsigned int p;
+	for( p = 0 ; p < PRODUCTORES ; p++ )
+		recibidos[p] += cuenta[p];
+	pthread_mutex_unlock( &cerrojo );
+	
+	return NULL;
+	
+}
+
+int main()
+{
+	
+	unsigned int errores = 0;
+	Cola_Iniciar( &c , CAPACIDAD , sizeof( elemento ) );
+	
+	pthread_t productores[PRODUCTORES];
+	pthread_t consumidores[CONSUMIDORES];
+	unsigned int numeros[PRODUCTORES];
+	unsigned int pos;
+	for( pos = 0 ; pos < CONSUMIDORES ; pos++ )
+		pthread_create( &consumidores[pos] , NULL , Consumir , NULL );
+	for( pos = 0 ; pos < PRODUCTORES ; pos++ )
+	{
+		
+		numeros[pos] = pos;
+		pthread_create( &productores[pos] , NULL , Producir ,
+						&numeros[pos] );
+		
+	}
+	
+	///Al cerrar, los consumidores terminan de sacar lo que queda
+	for( pos = 0 ; pos < PRODUCTORES ; pos++ )
+		pthread_join( productores[pos] , NULL );
+	Cola_Cerrar( &c );
+	for( pos = 0 ; pos < CONSUMIDORES ; pos++ )
+		pthread_join( consumidores[pos] , NULL );
+	
+	for( pos = 0 ; pos < PRODUCTORES ; pos++ )
+		if( recibidos[pos] != POR_PRODUCTOR )
+			errores++;
+	if( desordenados != 0 || c.cant != 0 )
+		errores++;
+	
+	///Cerrada, ya no acepta elementos
+	elemento e = { 0 , 0 };
+	if( Cola_Poner( &c , &e ) || Cola_Sacar( &c , &e ) ||
+		Cola_Intentar_poner( &c , &e ) != -1 )
+		errores++;
+	Cola_Liberar( &c );
+	
+	///Sin esperar: llena, no se pone nada hasta que se saque uno
+	Cola_Iniciar( &c , CAPACIDAD , sizeof( elemento ) );
+	for( pos = 0 ; pos < CAPACIDAD ; pos++ )
+	{
+		
+		e.numero = pos;
+		if( Cola_Intentar_poner( &c , &e ) != 1 )
+			errores++;
+		
+	}
+	e.numero = CAPACIDAD;
+	if( Cola_Intentar_poner( &c , &e ) != 0 || c.cant != CAPACIDAD ||
+		!Cola_Sacar( &c , &e ) || e.numero != 0 ||
+		Cola_Intentar_poner( &c , &e ) != 1 )
+		errores++;
+	Cola_Liberar( &c );
+	
+	printf( "\n errores = %u\n" , errores );
+	
+	return errores != 0;
+	
+}
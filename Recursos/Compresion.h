@@ -0,0 +1,436 @@
+/**
+ * @author Fernández Nicolás (nicofernandez@alumnos.unc.edu.ar)
+ * @date Mayo, 2017
+ * @version 0.5.2017 beta
+ *
+ * @brief Compresión de series de tiempo por bloques de filas: XOR de
+ * flotantes consecutivos (Gorilla) con un mapa de bits de los datos
+ * faltantes (NAN) y delta de deltas para enteros (marcas de tiempo).
+ * Cada bloque se descomprime completo en un vector, de una pasada
+ *
+ * \file Compresion.h
+ */
+
+#ifndef COMPRESION_H
+#define COMPRESION_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include "Mem.h"
+
+///Filas por bloque (múltiplo de 64, por el mapa de bits)
+#define COMPRESION_BLOQUE 1024
+///Bytes en cero al final de los datos para leer de a 8 sin controlar
+#define COMPRESION_MARGEN 8
+
+typedef struct {
+	
+	unsigned char * datos;
+	size_t bytes; /// completos en 'datos'
+	size_t asignados;
+	uint64_t acumulador; /// bits aún no copiados a 'datos'
+	unsigned int ocupados;
+	
+} bits_escritor;
+
+typedef struct {
+	
+	const unsigned char * datos;
+	size_t pos; /// en bits
+	
+} bits_lector;
+
+///Bloque de flotantes: solo se guardan los valores presentes
+typedef struct {
+	
+	uint32_t filas;
+	uint32_t bytes;
+	uint64_t presentes[COMPRESION_BLOQUE / 64]; /// bit en 1: hay dato
+	unsigned char * datos;
+	
+} bloque_flotantes;
+
+typedef struct {
+	
+	uint32_t filas;
+	uint32_t bytes;
+	unsigned char * datos;
+	
+} bloque_enteros;
+
+void Compresion_Escribir_byte( bits_escritor * e , unsigned char byte )
+{
+	
+	if( e->bytes + COMPRESION_MARGEN >= e->asignados )
+	{
+		
+		e->asignados = e->asignados * 2 + 64;
+		e->datos = Mem_reassign( e->datos , e->asignados );
+		
+	}
+	e->datos[e->bytes++] = byte;
+	
+}
+
+/**
+ * @brief Agrega los 'n' bits menos significativos de 'valor' (n <= 32),
+ * el más significativo primero
+ */
+void Compresion_Escribir_bits( bits_escritor * e , uint64_t valor ,
+							   unsigned int n )
+{
+	
+	if( n == 0 )
+		return;
+	
+	e->acumulador = ( e->acumulador << n ) |
+					( valor & ( ( (uint64_t)1 << n ) - 1 ) );
+	e->ocupados += n;
+	while( e->ocupados >= 8 )
+	{
+		
+		e->ocupados -= 8;
+		Compresion_Escribir_byte( e , e->acumulador >> e->ocupados );
+		
+	}
+	
+}
+
+void Compresion_Escribir_64( bits_escritor * e , uint64_t valor )
+{
+	
+	Compresion_Escribir_bits( e , valor >> 32 , 32 );
+	Compresion_Escribir_bits( e , valor , 32 );
+	
+}
+
+/**
+ * @brief Completa el último byte y deja el margen en cero
+ *
+ * @return cantidad de bytes escritos (sin el margen)
+ */
+uint32_t Compresion_Cerrar( bits_escritor * e )
+{
+	
+	if( e->ocupados > 0 )
+		Compresion_Escribir_bits( e , 0 , 8 - e->ocupados );
+	if( e->datos == NULL )
+		Compresion_Escribir_byte( e , 0 );
+	memset( &e->datos[e->bytes] , 0 , COMPRESION_MARGEN );
+	
+	return e->bytes;
+	
+}
+
+/**
+ * @brief Lee 'n' bits (n <= 32) como entero sin signo
+ */
+uint32_t Compresion_Leer_bits( bits_lector * l , unsigned int n )
+{
+	
+	if( n == 0 )
+		return 0;
+	
+	///Cargo 8 bytes en orden de bits y descarto los ya leídos
+	uint64_t palabra;
+	memcpy( &palabra , &l->datos[l->pos >> 3] , 8 );
+	palabra = __builtin_bswap64( palabra ) << ( l->pos & 7 );
+	l->pos += n;
+	
+	return palabra >> ( 64 - n );
+	
+}
+
+uint64_t Compresion_Leer_64( bits_lector * l )
+{
+	
+	uint64_t alto = Compresion_Leer_bits( l , 32 );
+	
+	return ( alto << 32 ) | Compresion_Leer_bits( l , 32 );
+	
+}
+
+uint32_t Compresion_Bits_de_flotante( float valor )
+{
+	
+	uint32_t bits;
+	memcpy( &bits , &valor , 4 );
+	
+	return bits;
+	
+}
+
+/**
+ * @brief Comprime hasta COMPRESION_BLOQUE flotantes: los NAN se marcan
+ * en el mapa de bits y no ocupan lugar; de cada valor se guarda el XOR
+ * con el anterior, reusando la ventana de bits significativos
+ */
+void Compresion_Comprimir_flotantes( const float * valores ,
+									 unsigned int filas ,
+									 bloque_flotantes * bloque )
+{
+	
+	memset( bloque , 0 , sizeof( bloque_flotantes ) );
+	bloque->filas = filas;
+	bits_escritor e;
+	memset( &e , 0 , sizeof( e ) );
+	
+	int primero = 1;
+	uint32_t anterior = 0;
+	unsigned int ceros_izq = 64; /// sin ventana previa
+	unsigned int ceros_der = 0;
+	unsigned int fila;
+	for( fila = 0 ; fila < filas ; fila++ )
+	{
+		
+		if( __builtin_isnan( valores[fila] ) )
+			continue;
+		bloque->presentes[fila / 64] |= (uint64_t)1 << ( fila % 64 );
+		
+		uint32_t actual = Compresion_Bits_de_flotante( valores[fila] );
+		if( primero )
+		{
+			
+			Compresion_Escribir_bits( &e , actual , 32 );
+			anterior = actual;
+			primero = 0;
+			continue;
+			
+		}
+		
+		uint32_t xor = actual ^ anterior;
+		anterior = actual;
+		if( xor == 0 )
+		{
+			
+			Compresion_Escribir_bits( &e , 0 , 1 );
+			continue;
+			
+		}
+		
+		unsigned int izq = __builtin_clz( xor );
+		unsigned int der = __builtin_ctz( xor );
+		if( ceros_izq <= 31 && izq >= ceros_izq && der >= ceros_der )
+		{
+			
+			///Entra en la ventana anterior
+			Compresion_Escribir_bits( &e , 2 , 2 );
+			Compresion_Escribir_bits( &e ,
+									  xor >> ceros_der ,
+									  32 - ceros_izq - ceros_der );
+			
+		}
+		else
+		{
+			
+			unsigned int largo = 32 - izq - der;
+			Compresion_Escribir_bits( &e , 3 , 2 );
+			Compresion_Escribir_bits( &e , izq , 5 );
+			Compresion_Escribir_bits( &e , largo - 1 , 5 );
+			Compresion_Escribir_bits( &e , xor >> der , largo );
+			ceros_izq = izq;
+			ceros_der = der;
+			
+		}
+		
+	}
+	
+	bloque->bytes = Compresion_Cerrar( &e );
+	bloque->datos = e.datos;
+	
+}
+
+/**
+ * @brief Descomprime un bloque completo, con NAN en los faltantes
+ *
+ * @param valores : vector de al menos COMPRESION_BLOQUE flotantes
+ * @return cantidad de filas del bloque
+ */
+unsigned int Compresion_Descomprimir_flotantes
+( const bloque_flotantes * bloque , float * valores )
+{
+	
+	bits_lector l;
+	l.datos = bloque->datos;
+	l.pos = 0;
+	
+	int primero = 1;
+	uint32_t anterior = 0;
+	unsigned int ceros_izq = 0;
+	unsigned int ceros_der = 0;
+	unsigned int fila;
+	for( fila = 0 ; fila < bloque->filas ; fila++ )
+	{
+		
+		if( !( bloque->presentes[fila / 64] >> ( fila % 64 ) & 1 ) )
+		{
+			
+			valores[fila] = __builtin_nanf( "" );
+			continue;
+			
+		}
+		
+		if( primero )
+		{
+			
+			anterior = Compresion_Leer_bits( &l , 32 );
+			primero = 0;
+			
+		}
+		else if( Compresion_Leer_bits( &l , 1 ) == 1 )
+		{
+			
+			if( Compresion_Leer_bits( &l , 1 ) == 1 )
+			{
+				
+				ceros_izq = Compresion_Leer_bits( &l , 5 );
+				unsigned int largo = Compresion_Leer_bits( &l , 5 ) + 1;
+				ceros_der = 32 - ceros_izq - largo;
+				
+			}
+			unsigned int largo = 32 - ceros_izq - ceros_der;
+			anterior ^= Compresion_Leer_bits( &l , largo ) << ceros_der;
+			
+		}
+		memcpy( &valores[fila] , &anterior , 4 );
+		
+	}
+	
+	return bloque->filas;
+	
+}
+
+/**
+ * @brief Comprime hasta COMPRESION_BLOQUE enteros con delta de deltas:
+ * una serie a intervalos regulares ocupa un bit por valor. Las
+ * diferencias se calculan sin signo, así que cualquier valor (incluso
+ * INT64_MIN como marca de faltante) vuelve igual
+ */
+void Compresion_Comprimir_enteros( const int64_t * valores ,
+								   unsigned int filas ,
+								   bloque_enteros * bloque )
+{
+	
+	bloque->filas = filas;
+	bits_escritor e;
+	memset( &e , 0 , sizeof( e ) );
+	
+	int64_t delta = 0;
+	unsigned int fila;
+	for( fila = 0 ; fila < filas ; fila++ )
+	{
+		
+		if( fila == 0 )
+		{
+			
+			Compresion_Escribir_64( &e , valores[0] );
+			continue;
+			
+		}
+		
+		int64_t nuevo_delta = (uint64_t)valores[fila] -
+							  (uint64_t)valores[fila - 1];
+		int64_t dd = (uint64_t)nuevo_delta - (uint64_t)delta;
+		delta = nuevo_delta;
+		if( dd == 0 )
+			Compresion_Escribir_bits( &e , 0 , 1 );
+		else if( dd >= -63 && dd <= 64 )
+		{
+			
+			Compresion_Escribir_bits( &e , 2 , 2 );
+			Compresion_Escribir_bits( &e , dd + 63 , 7 );
+			
+		}
+		else if( dd >= -255 && dd <= 256 )
+		{
+			
+			Compresion_Escribir_bits( &e , 6 , 3 );
+			Compresion_Escribir_bits( &e , dd + 255 , 9 );
+			
+		}
+		else if( dd >= -2047 && dd <= 2048 )
+		{
+			
+			Compresion_Escribir_bits( &e , 14 , 4 );
+			Compresion_Escribir_bits( &e , dd + 2047 , 12 );
+			
+		}
+		else
+		{
+			
+			Compresion_Escribir_bits( &e , 15 , 4 );
+			Compresion_Escribir_64( &e , dd );
+			
+		}
+		
+	}
+	
+	bloque->bytes = Compresion_Cerrar( &e );
+	bloque->datos = e.datos;
+	
+}
+
+/**
+ * @param valores : vector de al menos COMPRESION_BLOQUE enteros
+ * @return cantidad de filas del bloque
+ */
+unsigned int Compresion_Descomprimir_enteros
+( const bloque_enteros * bloque , int64_t * valores )
+{
+	
+	bits_lector l;
+	l.datos = bloque->datos;
+	l.pos = 0;
+	
+	int64_t delta = 0;
+	unsigned int fila;
+	for( fila = 0 ; fila < bloque->filas ; fila++ )
+	{
+		
+		if( fila == 0 )
+		{
+			
+			valores[0] = Compresion_Leer_64( &l );
+			continue;
+			
+		}
+		
+		int64_t dd = 0;
+		if( Compresion_Leer_bits( &l , 1 ) == 1 )
+		{
+			
+			if( Compresion_Leer_bits( &l , 1 ) == 0 )
+				dd = (int64_t)Compresion_Leer_bits( &l , 7 ) - 63;
+			else if( Compresion_Leer_bits( &l , 1 ) == 0 )
+				dd = (int64_t)Compresion_Leer_bits( &l , 9 ) - 255;
+			else if( Compresion_Leer_bits( &l , 1 ) == 0 )
+				dd = (int64_t)Compresion_Leer_bits( &l , 12 ) - 2047;
+			else
+				dd = Compresion_Leer_64( &l );
+			
+		}
+		delta = (uint64_t)delta + (uint64_t)dd;
+		valores[fila] = (uint64_t)valores[fila - 1] + (uint64_t)delta;
+		
+	}
+	
+	return bloque->filas;
+	
+}
+
+void Compresion_Liberar_flotantes( bloque_flotantes * bloque )
+{
+	
+	Mem_desassign( (void **)&bloque->datos );
+	
+}
+
+void Compresion_Liberar_enteros( bloque_enteros * bloque )
+{
+	
+	Mem_desassign( (void **)&bloque->datos );
+	
+}
+
+#endif
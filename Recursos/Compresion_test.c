@@ -0,0 +1,88 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>		/* rand */
+#include <math.h>		/* NAN */
+
+#include "Compresion.h"
+
+int main()
+{
+	
+	float valores[COMPRESION_BLOQUE];
+	float descomprimidos[COMPRESION_BLOQUE];
+	int64_t tiempos[COMPRESION_BLOQUE];
+	int64_t tiempos_descomprimidos[COMPRESION_BLOQUE];
+	unsigned int errores = 0;
+	size_t bytes = 0;
+	size_t filas_total = 0;
+	
+	unsigned int prueba;
+	for( prueba = 0 ; prueba < 2000 ; prueba++ )
+	{
+		
+		///Series suaves, ruidosas, constantes y con faltantes
+		unsigned int filas = 1 + rand() % COMPRESION_BLOQUE;
+		float valor = ( rand() % 2000 - 1000 ) / 10.0f;
+		unsigned int fila;
+		for( fila = 0 ; fila < filas ; fila++ )
+		{
+			
+			if( prueba % 4 == 1 )
+				valor = ( rand() % 2000000 - 1000000 ) / 7.0f;
+			else if( prueba % 4 != 2 && rand() % 3 == 0 )
+				valor += ( rand() % 11 - 5 ) / 10.0f;
+			valores[fila] = ( rand() % 20 == 0 ) ? NAN : valor;
+			
+		}
+		
+		bloque_flotantes bloque;
+		Compresion_Comprimir_flotantes( valores , filas , &bloque );
+		unsigned int leidas;
+		leidas = Compresion_Descomprimir_flotantes( &bloque ,
+													descomprimidos );
+		if( leidas != filas )
+			errores++;
+		for( fila = 0 ; fila < filas ; fila++ )
+			if( isnan( valores[fila] ) ?
+				!isnan( descomprimidos[fila] ) :
+				memcmp( &valores[fila] , &descomprimidos[fila] , 4 ) )
+			{
+				
+				errores++;
+				break;
+				
+			}
+		bytes += bloque.bytes;
+		filas_total += filas;
+		Compresion_Liberar_flotantes( &bloque );
+		
+		///Marcas cada 10 minutos con saltos ocasionales
+		int64_t tiempo = (int64_t)1469664000 + rand();
+		for( fila = 0 ; fila < filas ; fila++ )
+		{
+			
+			tiempo += 600;
+			if( rand() % 50 == 0 )
+				tiempo += ( rand() % 3 == 0 ) ? (int64_t)rand() * 1000 :
+											   rand() % 5000 - 2500;
+			tiempos[fila] = tiempo;
+			
+		}
+		bloque_enteros enteros;
+		Compresion_Comprimir_enteros( tiempos , filas , &enteros );
+		Compresion_Descomprimir_enteros( &enteros ,
+										 tiempos_descomprimidos );
+		if( memcmp( tiempos ,
+					tiempos_descomprimidos ,
+					filas * sizeof( int64_t ) ) != 0 )
+			errores++;
+		Compresion_Liberar_enteros( &enteros );
+		
+	}
+	
+	printf( "\n bits por flotante = %.2f" , bytes * 8.0 / filas_total );
+	printf( "\n errores = %u\n" , errores );
+	
+	return errores != 0;
+	
+}
@@ -0,0 +1,317 @@
+/**
+ * @author Fernández Nicolás (nicofernandez@alumnos.unc.edu.ar)
+ * @date Mayo, 2017
+ * @version 0.5.2017 beta
+ *
+ * @brief Cuantiles aproximados de una serie de valores (t-digest):
+ * los valores se resumen en centroides (media y peso) más chicos
+ * cerca de los extremos, de forma que la mediana o el percentil 99 se
+ * estiman recorriendo solo los centroides, sin importar cuántos
+ * valores se agregaron. Dos resúmenes se pueden juntar
+ *
+ * \file Cuantiles.h
+ */
+
+#ifndef CUANTILES_H
+#define CUANTILES_H
+
+#include <math.h> //asin , sin , NAN
+#include <stdint.h>
+#include <string.h>
+
+#include "Mem.h"
+
+///Compresión (delta): cantidad de centroides y precisión del resumen
+#define CUANTILES_COMPRESION 100
+///Valores que se acumulan antes de juntarlos con los centroides
+#define CUANTILES_PENDIENTES 1024
+
+typedef struct {
+	
+	double media;
+	double peso; /// cantidad de valores que resume
+	
+} centroide;
+
+///Un resumen en cero (memset) está vacío y listo para usar
+typedef struct {
+	
+	centroide * centroides; /// ordenados por media
+	unsigned int cant;
+	float * pendientes; /// sin ordenar, aún no resumidos
+	unsigned int cant_pendientes;
+	double total; /// cantidad de valores, incluso los pendientes
+	double minimo;
+	double maximo;
+	
+} cuantiles;
+
+/**
+ * @brief Ordena flotantes (sin NAN) por radix de a 8 bits: los bits
+ * se transforman en claves que se ordenan como enteros sin signo. Sin
+ * comparaciones, el costo no depende de saltos mal predichos
+ *
+ * @param n : hasta CUANTILES_PENDIENTES
+ */
+void Cuantiles_Ordenar( float * valores , unsigned int n )
+{
+	
+	uint32_t claves[CUANTILES_PENDIENTES];
+	uint32_t auxiliar[CUANTILES_PENDIENTES];
+	unsigned int pos;
+	for( pos = 0 ; pos < n ; pos++ )
+	{
+		
+		uint32_t bits;
+		memcpy( &bits , &valores[pos] , 4 );
+		claves[pos] = bits >> 31 ? ~bits : bits | 0x80000000u;
+		
+	}
+	
+	uint32_t * origen = claves;
+	uint32_t * destino = auxiliar;
+	unsigned int corrimiento;
+	for( corrimiento = 0 ; corrimiento < 32 ; corrimiento += 8 )
+	{
+		
+		unsigned int inicio[257];
+		memset( inicio , 0 , sizeof( inicio ) );
+		for( pos = 0 ; pos < n ; pos++ )
+			inicio[( origen[pos] >> corrimiento & 255 ) + 1]++;
+		///Si todos comparten el byte, el paso no cambia nada
+		if( inicio[( origen[0] >> corrimiento & 255 ) + 1] == n )
+			continue;
+		
+		unsigned int byte;
+		for( byte = 1 ; byte < 256 ; byte++ )
+			inicio[byte] += inicio[byte - 1];
+		for( pos = 0 ; pos < n ; pos++ )
+			destino[inicio[origen[pos] >> corrimiento & 255]++] =
+				origen[pos];
+		uint32_t * cambio = origen;
+		origen = destino;
+		destino = cambio;
+		
+	}
+	
+	for( pos = 0 ; pos < n ; pos++ )
+	{
+		
+		uint32_t bits = origen[pos];
+		bits = bits >> 31 ? bits & 0x7FFFFFFFu : ~bits;
+		memcpy( &valores[pos] , &bits , 4 );
+		
+	}
+	
+}
+
+/**
+ * @brief Fracción acumulada hasta la que puede llegar un centroide que
+ * empieza en 'q': la escala k = delta / 2pi * asin( 2q - 1 ) avanza a
+ * lo sumo 1 por centroide, lo que los achica cerca de 0 y de 1
+ */
+double Cuantiles_Limite( double q )
+{
+	
+	double k = CUANTILES_COMPRESION / ( 2 * M_PI ) * asin( 2 * q - 1 );
+	k += 1;
+		if( k >= CUANTILES_COMPRESION / 4.0 )
+			return 1;
+	
+	return ( sin( k * 2 * M_PI / CUANTILES_COMPRESION ) + 1 ) / 2;
+	
+}
+
+/**
+ * @brief Reemplaza los centroides por 'todos' (ordenados por media)
+ * uniendo vecinos mientras no superen su límite
+ *
+ * @param todos : vector propio que pasa a ser del resumen
+ */
+void Cuantiles_Resumir( cuantiles * c , centroide * todos ,
+						unsigned int cant )
+{
+	
+	unsigned int ultimo = 0;
+	double acumulado = 0;
+	double limite = c->total * Cuantiles_Limite( 0 );
+	unsigned int pos;
+	for( pos = 1 ; pos < cant ; pos++ )
+	{
+		
+		centroide * actual = &todos[ultimo];
+		if( acumulado + actual->peso + todos[pos].peso <= limite )
+		{
+			
+			actual->peso += todos[pos].peso;
+			actual->media += ( todos[pos].media - actual->media ) *
+							 todos[pos].peso / actual->peso;
+			
+		}
+		else
+		{
+			
+			acumulado += actual->peso;
+			limite = c->total *
+					 Cuantiles_Limite( acumulado / c->total );
+			todos[++ultimo] = todos[pos];
+			
+		}
+		
+	}
+	
+	Mem_desassign( (void **)&c->centroides );
+	c->cant = ultimo + 1;
+	c->centroides = Mem_reassign( todos ,
+								  c->cant * sizeof( centroide ) );
+	
+}
+
+/**
+ * @brief Junta los valores pendientes con los centroides, intercalando
+ * ambos ya ordenados
+ */
+void Cuantiles_Comprimir( cuantiles * c )
+{
+	
+		if( c->cant_pendientes == 0 )
+			return;
+	
+	Cuantiles_Ordenar( c->pendientes , c->cant_pendientes );
+	unsigned int cant = c->cant + c->cant_pendientes;
+	centroide * todos = Mem_assign_vector( cant , sizeof( centroide ) );
+	unsigned int viejo = 0 , nuevo = 0 , pos;
+	for( pos = 0 ; pos < cant ; pos++ )
+		if( nuevo == c->cant_pendientes ||
+			( viejo < c->cant &&
+			  c->centroides[viejo].media <= c->pendientes[nuevo] ) )
+			todos[pos] = c->centroides[viejo++];
+		else
+		{
+			
+			todos[pos].media = c->pendientes[nuevo++];
+			todos[pos].peso = 1;
+			
+		}
+	
+	c->cant_pendientes = 0;
+	Cuantiles_Resumir( c , todos , cant );
+	
+}
+
+void Cuantiles_Agregar( cuantiles * c , float valor )
+{
+	
+	if( c->pendientes == NULL )
+		c->pendientes = Mem_assign_vector( CUANTILES_PENDIENTES ,
+										   sizeof( float ) );
+	if( c->cant_pendientes == CUANTILES_PENDIENTES )
+		Cuantiles_Comprimir( c );
+	
+	if( c->total == 0 || valor < c->minimo )
+		c->minimo = valor;
+	if( c->total == 0 || valor > c->maximo )
+		c->maximo = valor;
+	c->pendientes[c->cant_pendientes++] = valor;
+	c->total++;
+	
+}
+
+/**
+ * @brief Agrega a 'destino' todo lo resumido en 'origen' (ambos quedan
+ * sin valores pendientes)
+ */
+void Cuantiles_Juntar( cuantiles * destino , cuantiles * origen )
+{
+	
+		if( origen->total == 0 )
+			return;
+	
+	Cuantiles_Comprimir( destino );
+	Cuantiles_Comprimir( origen );
+	if( destino->total == 0 || origen->minimo < destino->minimo )
+		destino->minimo = origen->minimo;
+	if( destino->total == 0 || origen->maximo > destino->maximo )
+		destino->maximo = origen->maximo;
+	destino->total += origen->total;
+	
+	unsigned int cant = destino->cant + origen->cant;
+	centroide * todos = Mem_assign_vector( cant , sizeof( centroide ) );
+	centroide * a = destino->centroides;
+	centroide * b = origen->centroides;
+	unsigned int de_a = 0 , de_b = 0 , pos;
+	for( pos = 0 ; pos < cant ; pos++ )
+		if( de_b == origen->cant ||
+			( de_a < destino->cant && a[de_a].media <= b[de_b].media ) )
+			todos[pos] = a[de_a++];
+		else
+			todos[pos] = b[de_b++];
+	
+	Cuantiles_Resumir( destino , todos , cant );
+	
+}
+
+/**
+ * @brief Valor aproximado del cuantil 'q' (de 0 a 1): se interpola
+ * entre los centros de los centroides vecinos y, en las colas, entre
+ * el primero o el último y el mínimo o el máximo
+ *
+ * @return cuantil o NAN si el resumen está vacío
+ */
+double Cuantiles_Cuantil( cuantiles * c , double q )
+{
+	
+	Cuantiles_Comprimir( c );
+		if( c->total == 0 )
+			return NAN;
+		if( c->minimo == c->maximo )
+			return c->minimo;
+	
+	double indice = q * c->total;
+		if( indice < 1 )
+			return c->minimo;
+		if( indice > c->total - 1 )
+			return c->maximo;
+	
+	centroide * primero = &c->centroides[0];
+	if( primero->peso > 2 && indice < primero->peso / 2 )
+		return c->minimo + ( indice - 1 ) / ( primero->peso / 2 - 1 ) *
+						   ( primero->media - c->minimo );
+	
+	double acumulado = primero->peso / 2;
+	unsigned int pos;
+	for( pos = 0 ; pos + 1 < c->cant ; pos++ )
+	{
+		
+		centroide * actual = &c->centroides[pos];
+		centroide * siguiente = &c->centroides[pos + 1];
+		double paso = ( actual->peso + siguiente->peso ) / 2;
+		if( acumulado + paso > indice )
+			return actual->media + ( indice - acumulado ) / paso *
+								   ( siguiente->media - actual->media );
+		acumulado += paso;
+		
+	}
+	
+	centroide * ultimo = &c->centroides[c->cant - 1];
+		if( ultimo->peso <= 2 )
+			return ultimo->media;
+	double fraccion = ( indice - acumulado ) / ( ultimo->peso / 2 - 1 );
+	
+	return ultimo->media + ( fraccion < 1 ? fraccion : 1 ) *
+						   ( c->maximo - ultimo->media );
+	
+}
+
+void Cuantiles_Liberar( cuantiles * c )
+{
+	
+	Mem_desassign( (void **)&c->centroides );
+	Mem_desassign( (void **)&c->pendientes );
+	c->cant = 0;
+	c->cant_pendientes = 0;
+	c->total = 0;
+	
+}
+
+#endif
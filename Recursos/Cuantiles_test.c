@@ -0,0 +1,163 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>		/* rand , qsort */
+#include <math.h>
+
+#include "Cuantiles.h"
+
+#define VALORES 200000
+#define PARTES 7
+
+int Comparar_flotantes( const void * a , const void * b )
+{
+	
+	float x = *(const float *)a;
+	float y = *(const float *)b;
+	
+	return ( x > y ) - ( x < y );
+	
+}
+
+/**
+ * @brief Fracción de los valores (ordenados) menores o iguales a 'x':
+ * el error de un cuantil se mide en posición, no en valor
+ */
+double Posicion( const float * ordenados , unsigned int n , double x )
+{
+	
+	unsigned int desde = 0 , hasta = n;
+	while( desde < hasta )
+	{
+		
+		unsigned int medio = desde + ( hasta - desde ) / 2;
+		if( ordenados[medio] <= x )
+			desde = medio + 1;
+		else
+			hasta = medio;
+		
+	}
+	
+	return (double)desde / n;
+	
+}
+
+int main()
+{
+	
+	static float valores[VALORES];
+	unsigned int errores = 0;
+	double peor = 0;
+	double cuantiles_prueba[] = { 0.01 , 0.1 , 0.25 , 0.5 , 0.75 ,
+								  0.9 , 0.95 , 0.99 , 0.999 };
+	unsigned int cant_q = sizeof( cuantiles_prueba ) / sizeof( double );
+	
+	unsigned int prueba;
+	for( prueba = 0 ; prueba < 4 ; prueba++ )
+	{
+		
+		///Uniforme, sesgada, con pocos valores repetidos y ordenada
+		cuantiles total;
+		cuantiles partes[PARTES];
+		memset( &total , 0 , sizeof( total ) );
+		memset( partes , 0 , sizeof( partes ) );
+		unsigned int pos;
+		for( pos = 0 ; pos < VALORES ; pos++ )
+		{
+			
+			double u = ( rand( ) + 1.0 ) / ( RAND_MAX + 2.0 );
+			if( prueba == 0 )
+				valores[pos] = u * 45 - 5;
+			else if( prueba == 1 )
+				valores[pos] = -log( u ) * 10;
+			else if( prueba == 2 )
+				valores[pos] = rand( ) % 5 * 0.5f;
+			else
+				valores[pos] = pos * 0.1f;
+			Cuantiles_Agregar( &total , valores[pos] );
+			Cuantiles_Agregar( &partes[pos % PARTES] , valores[pos] );
+			
+		}
+		
+		///El resumen juntado debe comportarse como el completo
+		cuantiles juntado;
+		memset( &juntado , 0 , sizeof( juntado ) );
+		for( pos = 0 ; pos < PARTES ; pos++ )
+			Cuantiles_Juntar( &juntado , &partes[pos] );
+		
+		qsort( valores , VALORES , sizeof( float ) ,
+			   Comparar_flotantes );
+		if( Cuantiles_Cuantil( &total , 0 ) != valores[0] ||
+			Cuantiles_Cuantil( &total , 1 ) != valores[VALORES - 1] ||
+			Cuantiles_Cuantil( &juntado , 0 ) != valores[0] ||
+			Cuantiles_Cuantil( &juntado , 1 ) != valores[VALORES - 1] )
+		{
+			
+			printf( "\n Error en los extremos (prueba %u)" , prueba );
+			errores++;
+			
+		}
+		
+		unsigned int q;
+		for( q = 0 ; q < cant_q ; q++ )
+		{
+			
+			double buscado = cuantiles_prueba[q];
+			double estimados[2];
+			estimados[0] = Cuantiles_Cuantil( &total , buscado );
+			estimados[1] = Cuantiles_Cuantil( &juntado , buscado );
+			unsigned int e;
+			for( e = 0 ; e < 2 ; e++ )
+			{
+				
+				///Un valor repetido vale en todas sus posiciones
+				double arriba = Posicion( valores , VALORES ,
+										  estimados[e] );
+				double abajo = Posicion( valores , VALORES ,
+										 nextafter( estimados[e] ,
+													-INFINITY ) );
+				double error = 0;
+				if( buscado > arriba )
+					error = buscado - arriba;
+				if( buscado < abajo )
+					error = abajo - buscado;
+				if( error > peor )
+					peor = error;
+				if( error > 0.005 )
+				{
+					
+					printf( "\n Error: cuantil %g = %g (posición %g)" ,
+							buscado , estimados[e] , arriba );
+					errores++;
+					
+				}
+				
+			}
+			
+		}
+		
+		if( total.cant > 2 * CUANTILES_COMPRESION )
+		{
+			
+			printf( "\n Error: %u centroides" , total.cant );
+			errores++;
+			
+		}
+		
+		Cuantiles_Liberar( &total );
+		Cuantiles_Liberar( &juntado );
+		for( pos = 0 ; pos < PARTES ; pos++ )
+			Cuantiles_Liberar( &partes[pos] );
+		
+	}
+	
+	cuantiles vacio;
+	memset( &vacio , 0 , sizeof( vacio ) );
+	if( !isnan( Cuantiles_Cuantil( &vacio , 0.5 ) ) )
+		errores++;
+	
+	printf( "\n peor error de posición = %g" , peor );
+	printf( "\n errores = %u\n" , errores );
+	
+	return errores != 0;
+	
+}
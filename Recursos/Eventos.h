@@ -0,0 +1,553 @@
+/**
+ * @author Fernández Nicolás (nicofernandez@alumnos.unc.edu.ar)
+ * @date Mayo, 2017
+ * @version 0.5.2017 beta
+ *
+ * @brief Entrada y salida sin bloquear para muchos descriptores desde
+ * un solo hilo: se piden operaciones (aceptar, recibir, enviar, leer)
+ * y Eventos_Esperar devuelve las que terminaron con su resultado. Por
+ * debajo se usa epoll: la operación se hace cuando el descriptor está
+ * listo. Compilando con -DEVENTOS_URING se usa io_uring si el sistema
+ * lo permite: las operaciones pedidas se envían juntas al núcleo en
+ * cada espera, con una sola llamada al sistema para todas
+ *
+ * \file Eventos.h
+ */
+
+#ifndef EVENTOS_H
+#define EVENTOS_H
+
+#include <errno.h>
+#include <unistd.h> //read , close
+#include <sys/epoll.h>
+#include <sys/socket.h> //accept , recv , send
+#ifdef EVENTOS_URING
+#include <poll.h> //POLLIN , POLLOUT
+#include <stdint.h> //uintptr_t
+#include <string.h> //memset
+#include <sys/mman.h> //mmap
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#endif
+
+///Operaciones que se atienden por cada espera
+#define EVENTOS_LOTE 256
+///Operaciones que se pueden pedir entre dos esperas sin enviarlas
+#define EVENTOS_ENTRADAS 1024
+
+typedef enum {
+	
+	EVENTOS_ACEPTAR , /// buffer: struct sockaddr_in del cliente
+	EVENTOS_RECIBIR ,
+	EVENTOS_ENVIAR ,
+	EVENTOS_LEER /// read(), para eventfd o pipes
+	
+} eventos_tipo;
+
+/**
+ * Cada descriptor tiene a lo sumo una operación pendiente y usa
+ * siempre la misma estructura, que debe seguir existiendo hasta que
+ * la operación termine. Recibir y enviar no bloquean aunque el socket
+ * sea bloqueante; para aceptar o leer debe tener O_NONBLOCK
+ */
+typedef struct eventos_operacion {
+	
+	eventos_tipo tipo;
+	int fd;
+	void * buffer;
+	size_t tam;
+	void * dato; /// de quien la pide
+	long int resultado; /// bytes, descriptor aceptado o -errno
+	socklen_t largo_direccion; /// del cliente aceptado
+	int registrado; /// el descriptor ya está en epoll
+	struct eventos_operacion * siguiente; /// en la lista de terminadas
+	
+} eventos_operacion;
+
+#ifdef EVENTOS_URING
+
+/**
+ * Colas compartidas con el núcleo: en una se ponen los pedidos (sqe) y
+ * en la otra aparecen los resultados (cqe), con el user_data del
+ * pedido. Un user_data impar es la espera de que el descriptor esté
+ * listo, antes de repetir la operación que devolvió EAGAIN
+ */
+typedef struct {
+	
+	int fd; /// -1 si no se usa
+	void * pedidos_mapa;
+	size_t pedidos_tam;
+	void * resultados_mapa;
+	size_t resultados_tam;
+	struct io_uring_sqe * sqes;
+	size_t sqes_tam;
+	unsigned int entradas;
+	unsigned int * pedidos_cabeza;
+	unsigned int * pedidos_cola;
+	unsigned int * pedidos_mascara;
+	unsigned int * pedidos_indices;
+	unsigned int * resultados_cabeza;
+	unsigned int * resultados_cola;
+	unsigned int * resultados_mascara;
+	struct io_uring_cqe * cqes;
+	unsigned int por_enviar; /// pedidos puestos que el núcleo no vio
+	
+} eventos_anillo;
+
+void Eventos_Anillo_cerrar( eventos_anillo * a )
+{
+	
+		if( a->fd < 0 )
+			return;
+	
+	if( a->sqes != MAP_FAILED )
+		munmap( a->sqes , a->sqes_tam );
+	if( a->resultados_mapa != MAP_FAILED &&
+		a->resultados_mapa != a->pedidos_mapa )
+		munmap( a->resultados_mapa , a->resultados_tam );
+	if( a->pedidos_mapa != MAP_FAILED )
+		munmap( a->pedidos_mapa , a->pedidos_tam );
+	close( a->fd );
+	a->fd = -1;
+	
+}
+
+///Operaciones de io_uring que se usan
+#define EVENTOS_OPERACIONES_URING 5
+
+/**
+ * @brief Indica si el núcleo hace todas las operaciones que se usan.
+ * Entre 5.1 y 5.5 el anillo se crea pero algunas no existen y fallan
+ * recién al pedirlas (EINVAL); el sondeo es de 5.6, igual que ellas
+ */
+int Eventos_Anillo_completo( eventos_anillo * a )
+{
+	
+	static const unsigned char usadas[EVENTOS_OPERACIONES_URING] = {
+		IORING_OP_ACCEPT , IORING_OP_RECV , IORING_OP_SEND ,
+		IORING_OP_READ , IORING_OP_POLL_ADD };
+	uint64_t memoria[( sizeof( struct io_uring_probe ) + 256 *
+					   sizeof( struct io_uring_probe_op ) ) / 8];
+	memset( memoria , 0 , sizeof( memoria ) );
+	struct io_uring_probe * sondeo = (struct io_uring_probe *)memoria;
+		if( syscall( __NR_io_uring_register , a->fd ,
+					 IORING_REGISTER_PROBE , sondeo , 256 ) < 0 )
+			return 0;
+	
+	unsigned int pos;
+	for( pos = 0 ; pos < EVENTOS_OPERACIONES_URING ; pos++ )
+		if( usadas[pos] > sondeo->last_op ||
+			usadas[pos] >= sondeo->ops_len ||
+			!( sondeo->ops[usadas[pos]].flags &
+			   IO_URING_OP_SUPPORTED ) )
+			return 0;
+	
+	return 1;
+	
+}
+
+/**
+ * @return 0 o -1 si el sistema no permite io_uring o no hace todas
+ * las operaciones que se usan
+ */
+int Eventos_Anillo_iniciar( eventos_anillo * a , unsigned int entradas )
+{
+	
+	struct io_uring_params p;
+	memset( &p , 0 , sizeof( p ) );
+	memset( a , 0 , sizeof( eventos_anillo ) );
+	a->pedidos_mapa = MAP_FAILED;
+	a->resultados_mapa = MAP_FAILED;
+	a->sqes = MAP_FAILED;
+	a->fd = syscall( __NR_io_uring_setup , entradas , &p );
+		if( a->fd < 0 )
+			return -1;
+		if( !Eventos_Anillo_completo( a ) )
+		{
+			
+			Eventos_Anillo_cerrar( a );
+			return -1;
+			
+		}
+	
+	a->entradas = p.sq_entries;
+	a->pedidos_tam = p.sq_off.array + p.sq_entries * sizeof( unsigned );
+	a->resultados_tam = p.cq_off.cqes +
+						p.cq_entries * sizeof( struct io_uring_cqe );
+	///Con IORING_FEAT_SINGLE_MMAP ambas colas comparten el mapa
+	int un_mapa = p.features & IORING_FEAT_SINGLE_MMAP;
+	if( un_mapa && a->resultados_tam > a->pedidos_tam )
+		a->pedidos_tam = a->resultados_tam;
+	a->pedidos_mapa = mmap( NULL , a->pedidos_tam ,
+							PROT_READ | PROT_WRITE ,
+							MAP_SHARED | MAP_POPULATE , a->fd ,
+							IORING_OFF_SQ_RING );
+	if( un_mapa )
+		a->resultados_mapa = a->pedidos_mapa;
+	else
+		a->resultados_mapa = mmap( NULL , a->resultados_tam ,
+								   PROT_READ | PROT_WRITE ,
+								   MAP_SHARED | MAP_POPULATE , a->fd ,
+								   IORING_OFF_CQ_RING );
+	a->sqes_tam = p.sq_entries * sizeof( struct io_uring_sqe );
+	a->sqes = mmap( NULL , a->sqes_tam , PROT_READ | PROT_WRITE ,
+					MAP_SHARED | MAP_POPULATE , a->fd ,
+					IORING_OFF_SQES );
+	if( a->pedidos_mapa == MAP_FAILED ||
+		a->resultados_mapa == MAP_FAILED || a->sqes == MAP_FAILED )
+	{
+		
+		Eventos_Anillo_cerrar( a );
+		return -1;
+		
+	}
+	
+	char * pedidos = a->pedidos_mapa;
+	char * resultados = a->resultados_mapa;
+	a->pedidos_cabeza = (unsigned int *)( pedidos + p.sq_off.head );
+	a->pedidos_cola = (unsigned int *)( pedidos + p.sq_off.tail );
+	a->pedidos_mascara = (unsigned int *)( pedidos +
+										   p.sq_off.ring_mask );
+	a->pedidos_indices = (unsigned int *)( pedidos + p.sq_off.array );
+	a->resultados_cabeza = (unsigned int *)( resultados +
+											 p.cq_off.head );
+	a->resultados_cola = (unsigned int *)( resultados + p.cq_off.tail );
+	a->resultados_mascara = (unsigned int *)( resultados +
+											  p.cq_off.ring_mask );
+	a->cqes = (struct io_uring_cqe *)( resultados + p.cq_off.cqes );
+	
+	return 0;
+	
+}
+
+/**
+ * @brief Envía al núcleo los pedidos puestos y, si 'minimo' > 0,
+ * espera esa cantidad de resultados
+ *
+ * @return 0 o -1 si la llamada falló (por ejemplo, interrumpida)
+ */
+int Eventos_Anillo_entrar( eventos_anillo * a , unsigned int minimo )
+{
+	
+	long int enviados = syscall( __NR_io_uring_enter , a->fd ,
+								 a->por_enviar , minimo ,
+								 minimo > 0 ? IORING_ENTER_GETEVENTS :
+											  0 ,
+								 NULL , 0 );
+		if( enviados < 0 )
+			return -1;
+	
+	a->por_enviar -= enviados;
+	
+	return 0;
+	
+}
+
+/**
+ * @brief Pone el pedido de la operación (o, con 'sondeo', el de
+ * esperar que su descriptor esté listo) sin enviarlo
+ */
+void Eventos_Anillo_poner( eventos_anillo * a , eventos_operacion * op ,
+						   int sondeo )
+{
+	
+	///Llena, se vacía enviando lo puesto
+	unsigned int cola = *a->pedidos_cola;
+	if( cola - __atomic_load_n( a->pedidos_cabeza ,
+								__ATOMIC_ACQUIRE ) == a->entradas )
+		Eventos_Anillo_entrar( a , 0 );
+	
+	unsigned int indice = cola & *a->pedidos_mascara;
+	struct io_uring_sqe * sqe = &a->sqes[indice];
+	memset( sqe , 0 , sizeof( struct io_uring_sqe ) );
+	sqe->fd = op->fd;
+	sqe->user_data = (uintptr_t)op | ( sondeo ? 1 : 0 );
+	if( sondeo )
+	{
+		
+		sqe->opcode = IORING_OP_POLL_ADD;
+		sqe->poll_events = op->tipo == EVENTOS_ENVIAR ? POLLOUT :
+														 POLLIN;
+		
+	}
+	else
+	{
+		
+		sqe->addr = (uintptr_t)op->buffer;
+		sqe->len = op->tam;
+		switch( op->tipo )
+		{
+			
+			case EVENTOS_ACEPTAR:
+				sqe->opcode = IORING_OP_ACCEPT;
+				sqe->len = 0;
+				op->largo_direccion = op->tam;
+				sqe->addr2 = (uintptr_t)&op->largo_direccion;
+				break;
+			
+			case EVENTOS_RECIBIR:
+				sqe->opcode = IORING_OP_RECV;
+				break;
+			
+			case EVENTOS_ENVIAR:
+				sqe->opcode = IORING_OP_SEND;
+				sqe->msg_flags = MSG_NOSIGNAL;
+				break;
+			
+			default:
+				sqe->opcode = IORING_OP_READ;
+				sqe->off = (uint64_t)-1;
+			
+		}
+		
+	}
+	
+	a->pedidos_indices[indice] = indice;
+	__atomic_store_n( a->pedidos_cola , cola + 1 , __ATOMIC_RELEASE );
+	a->por_enviar++;
+	
+}
+
+/**
+ * @brief Envía lo puesto y recoge resultados; si no hay ninguno espera
+ * al menos uno
+ */
+unsigned int Eventos_Anillo_esperar( eventos_anillo * a ,
+									 eventos_operacion ** terminadas ,
+									 unsigned int maximo )
+{
+	
+	unsigned int cabeza = *a->resultados_cabeza;
+	int vacia = cabeza == __atomic_load_n( a->resultados_cola ,
+										   __ATOMIC_ACQUIRE );
+	if( ( vacia || a->por_enviar > 0 ) &&
+		Eventos_Anillo_entrar( a , vacia ? 1 : 0 ) < 0 )
+		return 0;
+	
+	unsigned int cant = 0;
+	while( cant < maximo &&
+		   cabeza != __atomic_load_n( a->resultados_cola ,
+									  __ATOMIC_ACQUIRE ) )
+	{
+		
+		struct io_uring_cqe * cqe;
+		cqe = &a->cqes[cabeza & *a->resultados_mascara];
+		uintptr_t dato = cqe->user_data;
+		int resultado = cqe->res;
+		cabeza++;
+		
+		///Un descriptor sin bloqueo devuelve EAGAIN: se espera que
+		///esté listo y se repite
+		eventos_operacion * op;
+		op = (eventos_operacion *)( dato & ~(uintptr_t)1 );
+		if( dato & 1 )
+			Eventos_Anillo_poner( a , op , 0 );
+		else if( resultado == -EAGAIN )
+			Eventos_Anillo_poner( a , op , 1 );
+		else
+		{
+			
+			op->resultado = resultado;
+			terminadas[cant++] = op;
+			
+		}
+		
+	}
+	__atomic_store_n( a->resultados_cabeza , cabeza ,
+					  __ATOMIC_RELEASE );
+	
+	return cant;
+	
+}
+
+#endif
+
+typedef struct {
+	
+	int epoll; /// -1 si se usa io_uring
+	eventos_operacion * terminadas; /// sin esperar (ver Eventos_Pedir)
+#ifdef EVENTOS_URING
+	eventos_anillo anillo;
+#endif
+	
+} eventos;
+
+/**
+ * @return 0 o -1 si no se pudo crear
+ */
+int Eventos_Iniciar( eventos * ev )
+{
+	
+	ev->terminadas = NULL;
+	ev->epoll = -1;
+#ifdef EVENTOS_URING
+	if( Eventos_Anillo_iniciar( &ev->anillo , EVENTOS_ENTRADAS ) == 0 )
+		return 0;
+#endif
+	ev->epoll = epoll_create1( EPOLL_CLOEXEC );
+	
+	return ev->epoll < 0 ? -1 : 0;
+	
+}
+
+///Mecanismo en uso: "io_uring" o "epoll"
+const char * Eventos_Mecanismo( eventos * ev )
+{
+	
+	return ev->epoll < 0 ? "io_uring" : "epoll";
+	
+}
+
+/**
+ * @brief Hace la operación sin esperar
+ *
+ * @return 1 si terminó (con su resultado) o 0 si el descriptor aún no
+ * está listo
+ */
+int Eventos_Intentar( eventos_operacion * op )
+{
+	
+	ssize_t hecho;
+	switch( op->tipo )
+	{
+		
+		case EVENTOS_ACEPTAR:
+			op->largo_direccion = op->tam;
+			hecho = accept( op->fd , op->buffer ,
+							&op->largo_direccion );
+			break;
+		
+		case EVENTOS_RECIBIR:
+			hecho = recv( op->fd , op->buffer , op->tam ,
+						  MSG_DONTWAIT );
+			break;
+		
+		case EVENTOS_ENVIAR:
+			hecho = send( op->fd , op->buffer , op->tam ,
+						  MSG_DONTWAIT | MSG_NOSIGNAL );
+			break;
+		
+		default:
+			hecho = read( op->fd , op->buffer , op->tam );
+		
+	}
+		if( hecho < 0 && ( errno == EAGAIN || errno == EWOULDBLOCK ||
+						   errno == EINTR ) )
+			return 0;
+	
+	op->resultado = hecho < 0 ? -errno : hecho;
+	
+	return 1;
+	
+}
+
+///Avisa una sola vez cuando el descriptor esté listo para la operación
+int Eventos_Armar( eventos * ev , eventos_operacion * op )
+{
+	
+	struct epoll_event evento;
+	evento.events = op->tipo == EVENTOS_ENVIAR ? EPOLLOUT : EPOLLIN;
+	evento.events |= EPOLLONESHOT;
+	evento.data.ptr = op;
+	int accion = op->registrado ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+	op->registrado = 1;
+	
+	return epoll_ctl( ev->epoll , accion , op->fd , &evento );
+	
+}
+
+/**
+ * @brief Pide la operación. Con epoll un envío se intenta enseguida,
+ * porque casi siempre hay lugar: si termina, sale en la próxima
+ * Eventos_Esperar. Con io_uring se envía al núcleo en esa espera
+ *
+ * @return 0 o -1 si el descriptor no se puede vigilar
+ */
+int Eventos_Pedir( eventos * ev , eventos_operacion * op )
+{
+	
+#ifdef EVENTOS_URING
+	if( ev->epoll < 0 )
+	{
+		
+		Eventos_Anillo_poner( &ev->anillo , op , 0 );
+		return 0;
+		
+	}
+#endif
+	if( op->tipo == EVENTOS_ENVIAR && Eventos_Intentar( op ) )
+	{
+		
+		op->siguiente = ev->terminadas;
+		ev->terminadas = op;
+		return 0;
+		
+	}
+	
+	return Eventos_Armar( ev , op );
+	
+}
+
+/**
+ * @brief Espera que termine al menos una operación
+ *
+ * @param terminadas : para guardar las operaciones terminadas
+ * @return cantidad de operaciones terminadas (0 si la espera fue
+ * interrumpida)
+ */
+unsigned int Eventos_Esperar( eventos * ev ,
+							  eventos_operacion ** terminadas ,
+							  unsigned int maximo )
+{
+	
+#ifdef EVENTOS_URING
+	if( ev->epoll < 0 )
+		return Eventos_Anillo_esperar( &ev->anillo , terminadas ,
+									   maximo );
+#endif
+	unsigned int cant = 0;
+	while( ev->terminadas != NULL && cant < maximo )
+	{
+		
+		terminadas[cant++] = ev->terminadas;
+		ev->terminadas = ev->terminadas->siguiente;
+		
+	}
+		if( cant == maximo )
+			return cant;
+	
+	///Con operaciones ya terminadas solo se miran las listas
+	struct epoll_event eventos[EVENTOS_LOTE];
+	int lote = EVENTOS_LOTE;
+	if( maximo - cant < EVENTOS_LOTE )
+		lote = maximo - cant;
+	int listos = epoll_wait( ev->epoll , eventos , lote ,
+							 cant > 0 ? 0 : -1 );
+	int pos;
+	for( pos = 0 ; pos < listos ; pos++ )
+	{
+		
+		eventos_operacion * op = eventos[pos].data.ptr;
+		if( Eventos_Intentar( op ) )
+			terminadas[cant++] = op;
+		else
+			Eventos_Armar( ev , op );
+		
+	}
+	
+	return cant;
+	
+}
+
+void Eventos_Cerrar( eventos * ev )
+{
+	
+#ifdef EVENTOS_URING
+	Eventos_Anillo_cerrar( &ev->anillo );
+#endif
+	if( ev->epoll >= 0 )
+		close( ev->epoll );
+	
+}
+
+#endif
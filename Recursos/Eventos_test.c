@@ -0,0 +1,198 @@
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/eventfd.h>
+#include <netinet/in.h>
+
+#include "Eventos.h"
+
+#define PARES 50
+#define GRANDE ( 4 << 20 )
+
+///Espera hasta que termine 'buscada'; las demás no deberían terminar
+int Esperar( eventos * ev , eventos_operacion * buscada )
+{
+	
+	eventos_operacion * terminadas[8];
+	unsigned int otras = 0;
+	while( 1 )
+	{
+		
+		unsigned int cant = Eventos_Esperar( ev , terminadas , 8 );
+		unsigned int pos;
+		for( pos = 0 ; pos < cant ; pos++ )
+			if( terminadas[pos] == buscada )
+				return otras;
+			else
+				otras++;
+		
+	}
+	
+}
+
+int main()
+{
+	
+	unsigned int errores = 0;
+	eventos ev;
+	if( Eventos_Iniciar( &ev ) != 0 )
+		return 1;
+	
+	///Muchos pares: cada recepción termina con lo que envió su par
+	int pares[PARES][2];
+	eventos_operacion recibir[PARES];
+	char recibido[PARES][16];
+	unsigned int pos;
+	for( pos = 0 ; pos < PARES ; pos++ )
+	{
+		
+		socketpair( AF_UNIX , SOCK_STREAM , 0 , pares[pos] );
+		memset( &recibir[pos] , 0 , sizeof( eventos_operacion ) );
+		recibir[pos].tipo = EVENTOS_RECIBIR;
+		recibir[pos].fd = pares[pos][0];
+		recibir[pos].buffer = recibido[pos];
+		recibir[pos].tam = sizeof( recibido[pos] );
+		recibir[pos].dato = &pares[pos];
+		Eventos_Pedir( &ev , &recibir[pos] );
+		
+	}
+	for( pos = PARES ; pos-- > 0 ; )
+	{
+		
+		char texto[16];
+		int largo = sprintf( texto , "par %u" , pos );
+		if( write( pares[pos][1] , texto , largo ) != largo )
+			errores++;
+		
+	}
+	unsigned int terminadas_cant = 0;
+	while( terminadas_cant < PARES )
+	{
+		
+		eventos_operacion * terminadas[16];
+		unsigned int cant = Eventos_Esperar( &ev , terminadas , 16 );
+		unsigned int t;
+		for( t = 0 ; t < cant ; t++ )
+		{
+			
+			eventos_operacion * op = terminadas[t];
+			unsigned int par = op - recibir;
+			char texto[16];
+			int largo = sprintf( texto , "par %u" , par );
+			if( op->resultado != largo ||
+				memcmp( op->buffer , texto , largo ) != 0 )
+				errores++;
+			terminadas_cant++;
+			
+		}
+		
+	}
+	
+	///Un envío grande termina de a partes, según lugar haya
+	static char grande[GRANDE];
+	memset( grande , 'g' , GRANDE );
+	eventos_operacion enviar;
+	memset( &enviar , 0 , sizeof( enviar ) );
+	enviar.tipo = EVENTOS_ENVIAR;
+	enviar.fd = pares[0][1];
+	size_t enviado = 0 , leido = 0;
+	static char lectura[GRANDE];
+	fcntl( pares[0][0] , F_SETFL , O_NONBLOCK );
+	ssize_t parte;
+	while( enviado < GRANDE )
+	{
+		
+		enviar.buffer = grande + enviado;
+		enviar.tam = GRANDE - enviado;
+		Eventos_Pedir( &ev , &enviar );
+		///Se lee todo lo que llegó para que vuelva a haber lugar
+		while( ( parte = read( pares[0][0] , lectura + leido ,
+							   GRANDE - leido ) ) > 0 )
+			leido += parte;
+		eventos_operacion * terminada;
+		while( Eventos_Esperar( &ev , &terminada , 1 ) == 0 );
+		if( terminada != &enviar || terminada->resultado <= 0 )
+		{
+			
+			errores++;
+			break;
+			
+		}
+		enviado += terminada->resultado;
+		
+	}
+	while( ( parte = read( pares[0][0] , lectura + leido ,
+						   GRANDE - leido ) ) > 0 )
+		leido += parte;
+	if( enviado != GRANDE || leido != GRANDE ||
+		memcmp( grande , lectura , GRANDE ) != 0 )
+		errores++;
+	
+	///Aceptar por TCP y leer un eventfd
+	int servidor = socket( AF_INET , SOCK_STREAM , 0 );
+	struct sockaddr_in direccion;
+	memset( &direccion , 0 , sizeof( direccion ) );
+	direccion.sin_family = AF_INET;
+	direccion.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+	socklen_t largo = sizeof( direccion );
+	bind( servidor , (struct sockaddr *)&direccion , largo );
+	listen( servidor , 4 );
+	getsockname( servidor , (struct sockaddr *)&direccion , &largo );
+	fcntl( servidor , F_SETFL , O_NONBLOCK );
+	struct sockaddr_in cliente;
+	eventos_operacion aceptar;
+	memset( &aceptar , 0 , sizeof( aceptar ) );
+	aceptar.tipo = EVENTOS_ACEPTAR;
+	aceptar.fd = servidor;
+	aceptar.buffer = &cliente;
+	aceptar.tam = sizeof( cliente );
+	Eventos_Pedir( &ev , &aceptar );
+	int conexion = socket( AF_INET , SOCK_STREAM , 0 );
+	connect( conexion , (struct sockaddr *)&direccion , largo );
+	if( Esperar( &ev , &aceptar ) != 0 || aceptar.resultado < 0 ||
+		aceptar.largo_direccion != sizeof( cliente ) ||
+		cliente.sin_addr.s_addr != htonl( INADDR_LOOPBACK ) )
+		errores++;
+	
+	int aviso = eventfd( 0 , EFD_NONBLOCK );
+	uint64_t avisos = 0 , uno = 1;
+	eventos_operacion leer;
+	memset( &leer , 0 , sizeof( leer ) );
+	leer.tipo = EVENTOS_LEER;
+	leer.fd = aviso;
+	leer.buffer = &avisos;
+	leer.tam = sizeof( avisos );
+	Eventos_Pedir( &ev , &leer );
+	if( write( aviso , &uno , sizeof( uno ) ) != sizeof( uno ) ||
+		write( aviso , &uno , sizeof( uno ) ) != sizeof( uno ) )
+		errores++;
+	if( Esperar( &ev , &leer ) != 0 || leer.resultado != 8 ||
+		avisos != 2 )
+		errores++;
+	
+	///Cerrar el otro extremo termina la recepción con 0
+	Eventos_Pedir( &ev , &recibir[1] );
+	close( pares[1][1] );
+	if( Esperar( &ev , &recibir[1] ) != 0 || recibir[1].resultado != 0 )
+		errores++;
+	
+	close( aceptar.resultado );
+	close( conexion );
+	close( servidor );
+	close( aviso );
+	for( pos = 0 ; pos < PARES ; pos++ )
+	{
+		
+		close( pares[pos][0] );
+		close( pares[pos][1] );
+		
+	}
+	Eventos_Cerrar( &ev );
+	
+	printf( "\n mecanismo = %s" , Eventos_Mecanismo( &ev ) );
+	printf( "\n errores = %u\n" , errores );
+	
+	return errores != 0;
+	
+}
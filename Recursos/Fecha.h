@@ -0,0 +1,374 @@
+/**
+ * @author Fernández Nicolás (nicofernandez@alumnos.unc.edu.ar)
+ * @date Mayo, 2017
+ * @version 0.5.2017 beta
+ *
+ * @brief Fechas como enteros: lectura de "dd/mm/aaaa hh:mm[:ss]" a
+ * segundos desde 1970 (sin zona horaria) y claves de día y de mes
+ * para agrupar comparando enteros en lugar de cadenas
+ *
+ * \file Fecha.h
+ */
+
+#ifndef FECHA_H
+#define FECHA_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "String.h"
+
+#define FECHA_SEGUNDOS_POR_DIA 86400
+///Largo de "dd/mm/aaaa hh:mm", el formato habitual
+#define FECHA_LARGO_FIJO 16
+///Bytes para escribir una fecha con Fecha_*_a_cadena
+#define FECHA_LARGO_CADENA 32
+
+/**
+ * @brief Días desde el 01/01/1970 de una fecha del calendario
+ * gregoriano (también para fechas anteriores)
+ */
+long int Fecha_Dias_desde_civil( long int anio , unsigned int mes ,
+								 unsigned int dia )
+{
+	
+	anio -= mes <= 2;
+	long int era = ( anio >= 0 ? anio : anio - 399 ) / 400;
+	unsigned int anio_de_era = anio - era * 400;
+	unsigned int dia_de_anio = ( 153 * ( mes > 2 ? mes - 3 : mes + 9 )
+								 + 2 ) / 5 + dia - 1;
+	unsigned int dia_de_era = anio_de_era * 365 + anio_de_era / 4
+							  - anio_de_era / 100 + dia_de_anio;
+	
+	return era * 146097 + (long int)dia_de_era - 719468;
+	
+}
+
+/**
+ * @brief Días del mes 'mes' (1 a 12) del año, con los bisiestos del
+ * calendario gregoriano
+ */
+unsigned int Fecha_Dias_del_mes( long int anio , unsigned int mes )
+{
+	
+	static const unsigned char dias[12] =
+		{ 31 , 28 , 31 , 30 , 31 , 30 , 31 , 31 , 30 , 31 , 30 , 31 };
+	int bisiesto = ( anio % 4 == 0 && anio % 100 != 0 ) ||
+				   anio % 400 == 0;
+	
+	return dias[mes - 1] + ( mes == 2 && bisiesto );
+	
+}
+
+/**
+ * @brief Fecha del calendario a partir de los días desde 01/01/1970
+ */
+void Fecha_Civil_de_dias( long int dias , long int * anio ,
+						  unsigned int * mes , unsigned int * dia )
+{
+	
+	dias += 719468;
+	long int era = ( dias >= 0 ? dias : dias - 146096 ) / 146097;
+	unsigned int dia_de_era = dias - era * 146097;
+	unsigned int anio_de_era = ( dia_de_era - dia_de_era / 1460
+								 + dia_de_era / 36524
+								 - dia_de_era / 146096 ) / 365;
+	unsigned int dia_de_anio = dia_de_era - ( 365 * anio_de_era
+											  + anio_de_era / 4
+											  - anio_de_era / 100 );
+	unsigned int mes_desde_marzo = ( 5 * dia_de_anio + 2 ) / 153;
+	
+	*dia = dia_de_anio - ( 153 * mes_desde_marzo + 2 ) / 5 + 1;
+	*mes = mes_desde_marzo < 10 ? mes_desde_marzo + 3 :
+								  mes_desde_marzo - 9;
+	*anio = anio_de_era + era * 400 + ( *mes <= 2 );
+	
+}
+
+/**
+ * @brief Lee 'n' dígitos fijos
+ *
+ * @return 1 o 0 si alguno no es dígito
+ */
+int Fecha_Digitos( const char * texto , unsigned int n ,
+				   unsigned int * valor )
+{
+	
+	*valor = 0;
+	unsigned int pos;
+	for( pos = 0 ; pos < n ; pos++ )
+	{
+		
+		unsigned int digito = (unsigned char)texto[pos] - '0';
+			if( digito > 9 )
+				return 0;
+		*valor = *valor * 10 + digito;
+		
+	}
+	
+	return 1;
+	
+}
+
+/**
+ * @brief Lee de 1 a 'maximo' dígitos seguidos del separador 'fin' (o
+ * del fin del texto si 'fin' es '\0')
+ *
+ * @return 1 o 0 si el número no tiene ese formato
+ */
+int Fecha_Campo( vista * resto , unsigned int maximo , char fin ,
+				 unsigned int * valor )
+{
+	
+	unsigned int largo = 0;
+	*valor = 0;
+	while( largo < resto->largo && largo < maximo )
+	{
+		
+		unsigned int digito = (unsigned char)resto->inicio[largo] - '0';
+		if( digito > 9 )
+			break;
+		*valor = *valor * 10 + digito;
+		largo++;
+		
+	}
+	
+		if( largo == 0 )
+			return 0;
+	
+	resto->inicio += largo;
+	resto->largo -= largo;
+	if( fin != '\0' )
+	{
+		
+			if( resto->largo == 0 || resto->inicio[0] != fin )
+				return 0;
+		resto->inicio++;
+		resto->largo--;
+		
+	}
+	
+	return 1;
+	
+}
+
+/**
+ * @brief Convierte una fecha "dd/mm/aaaa hh:mm" en segundos desde
+ * 01/01/1970; el formato fijo se lee por posición y como alternativa
+ * se aceptan día, mes y hora de un dígito y segundos (":ss")
+ *
+ * @param texto : campo de la fecha (lo que siga a la hora se ignora)
+ * @return 1 o 0 si no es una fecha válida
+ */
+int Fecha_Leer( vista texto , int64_t * segundos )
+{
+	
+	unsigned int dia , mes , anio , hora , minuto , segundo = 0;
+	const char * c = texto.inicio;
+	
+	int fijo = texto.largo >= FECHA_LARGO_FIJO &&
+			   c[2] == '/' && c[5] == '/' &&
+			   c[10] == ' ' && c[13] == ':' &&
+			   Fecha_Digitos( &c[0] , 2 , &dia ) &&
+			   Fecha_Digitos( &c[3] , 2 , &mes ) &&
+			   Fecha_Digitos( &c[6] , 4 , &anio ) &&
+			   Fecha_Digitos( &c[11] , 2 , &hora ) &&
+			   Fecha_Digitos( &c[14] , 2 , &minuto ) &&
+			   ( texto.largo == FECHA_LARGO_FIJO || c[16] != ':' );
+	if( !fijo )
+	{
+		
+		vista resto = texto;
+			if( !Fecha_Campo( &resto , 2 , '/' , &dia ) ||
+				!Fecha_Campo( &resto , 2 , '/' , &mes ) ||
+				!Fecha_Campo( &resto , 4 , ' ' , &anio ) ||
+				!Fecha_Campo( &resto , 2 , ':' , &hora ) ||
+				!Fecha_Campo( &resto , 2 , '\0' , &minuto ) )
+				return 0;
+		if( resto.largo > 0 && resto.inicio[0] == ':' )
+		{
+			
+			resto.inicio++;
+			resto.largo--;
+				if( !Fecha_Campo( &resto , 2 , '\0' , &segundo ) )
+					return 0;
+			
+		}
+		
+	}
+	
+		if( mes < 1 || mes > 12 || dia < 1 ||
+			dia > Fecha_Dias_del_mes( anio , mes ) ||
+			hora > 23 || minuto > 59 || segundo > 60 )
+			return 0;
+	
+	*segundos = (int64_t)Fecha_Dias_desde_civil( anio , mes , dia )
+				* FECHA_SEGUNDOS_POR_DIA
+				+ hora * 3600 + minuto * 60 + segundo;
+	
+	return 1;
+	
+}
+
+/**
+ * @brief Convierte un día "dd/mm/aaaa" (día y mes de uno o dos
+ * dígitos) en su clave de día
+ *
+ * @return 1 o 0 si no es una fecha válida
+ */
+int Fecha_Leer_dia( vista texto , long int * dia )
+{
+	
+	unsigned int dia_del_mes , mes , anio;
+	vista resto = texto;
+		if( !Fecha_Campo( &resto , 2 , '/' , &dia_del_mes ) ||
+			!Fecha_Campo( &resto , 2 , '/' , &mes ) ||
+			!Fecha_Campo( &resto , 4 , '\0' , &anio ) ||
+			resto.largo > 0 ||
+			mes < 1 || mes > 12 || dia_del_mes < 1 ||
+			dia_del_mes > Fecha_Dias_del_mes( anio , mes ) )
+			return 0;
+	
+	*dia = Fecha_Dias_desde_civil( anio , mes , dia_del_mes );
+	
+	return 1;
+	
+}
+
+/**
+ * @brief Clave de día (días desde 01/01/1970) de una marca de tiempo
+ */
+long int Fecha_Dia( int64_t segundos )
+{
+	
+	if( segundos >= 0 )
+		return segundos / FECHA_SEGUNDOS_POR_DIA;
+	
+	return -( ( -segundos + FECHA_SEGUNDOS_POR_DIA - 1 ) /
+			  FECHA_SEGUNDOS_POR_DIA );
+	
+}
+
+/**
+ * @brief Clave de hora (horas desde 01/01/1970) de una marca de tiempo
+ */
+long int Fecha_Hora( int64_t segundos )
+{
+	
+	if( segundos >= 0 )
+		return segundos / 3600;
+	
+	return -( ( -segundos + 3599 ) / 3600 );
+	
+}
+
+/**
+ * @brief Clave de mes (anio * 12 + mes - 1) de una clave de día
+ */
+long int Fecha_Mes( long int dia )
+{
+	
+	long int anio;
+	unsigned int mes , dia_del_mes;
+	Fecha_Civil_de_dias( dia , &anio , &mes , &dia_del_mes );
+	
+	return anio * 12 + mes - 1;
+	
+}
+
+/**
+ * @brief Escribe una clave de día como "dd/mm/aaaa"
+ *
+ * @param destino : al menos FECHA_LARGO_CADENA bytes
+ */
+void Fecha_Dia_a_cadena( long int dia , char * destino )
+{
+	
+	long int anio;
+	unsigned int mes , dia_del_mes;
+	Fecha_Civil_de_dias( dia , &anio , &mes , &dia_del_mes );
+	snprintf( destino , FECHA_LARGO_CADENA , "%02d/%02d/%04d" ,
+			  (int)dia_del_mes , (int)mes , (int)anio );
+	
+}
+
+/**
+ * @brief Escribe una marca de tiempo como "dd/mm/aaaa hh:mm", con
+ * ":ss" solo si los segundos no son cero
+ *
+ * @param destino : al menos FECHA_LARGO_CADENA bytes
+ * @return cantidad de caracteres escritos (sin el '\0')
+ */
+unsigned int Fecha_Tiempo_a_cadena( int64_t segundos , char * destino )
+{
+	
+	long int dia = Fecha_Dia( segundos );
+	int del_dia = segundos - (int64_t)dia * FECHA_SEGUNDOS_POR_DIA;
+	Fecha_Dia_a_cadena( dia , destino );
+	unsigned int largo = strlen( destino );
+	if( del_dia % 60 == 0 )
+		largo += snprintf( &destino[largo] ,
+						   FECHA_LARGO_CADENA - largo ,
+						   " %02d:%02d" ,
+						   del_dia / 3600 , del_dia / 60 % 60 );
+	else
+		largo += snprintf( &destino[largo] ,
+						   FECHA_LARGO_CADENA - largo ,
+						   " %02d:%02d:%02d" ,
+						   del_dia / 3600 , del_dia / 60 % 60 ,
+						   del_dia % 60 );
+	
+	return largo;
+	
+}
+
+/**
+ * @brief Escribe una clave de mes como "mm/aaaa"
+ *
+ * @param destino : al menos FECHA_LARGO_CADENA bytes
+ */
+void Fecha_Mes_a_cadena( long int mes , char * destino )
+{
+	
+	long int anio = mes >= 0 ? mes / 12 : -( ( 11 - mes ) / 12 );
+	snprintf( destino , FECHA_LARGO_CADENA , "%02d/%04d" ,
+			  (int)( mes - anio * 12 + 1 ) , (int)anio );
+	
+}
+
+/**
+ * @brief Agrega a la cadena una clave de día como "dd/mm/aaaa"
+ */
+void Fecha_Agregar_dia( cadena_creciente * c , long int dia )
+{
+	
+	char * fin = String_Creciente_Lugar( c , FECHA_LARGO_CADENA );
+	Fecha_Dia_a_cadena( dia , fin );
+	c->largo += strlen( fin );
+	
+}
+
+/**
+ * @brief Agrega a la cadena una clave de mes como "mm/aaaa"
+ */
+void Fecha_Agregar_mes( cadena_creciente * c , long int mes )
+{
+	
+	char * fin = String_Creciente_Lugar( c , FECHA_LARGO_CADENA );
+	Fecha_Mes_a_cadena( mes , fin );
+	c->largo += strlen( fin );
+	
+}
+
+/**
+ * @brief Agrega a la cadena una marca de tiempo (Fecha_Tiempo_a_cadena)
+ */
+void Fecha_Agregar_tiempo( cadena_creciente * c , int64_t segundos )
+{
+	
+	char * fin = String_Creciente_Lugar( c , FECHA_LARGO_CADENA );
+	c->largo += Fecha_Tiempo_a_cadena( segundos , fin );
+	
+}
+
+#endif
@@ -0,0 +1,156 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>		/* rand */
+#include <time.h>		/* timegm */
+
+#include "Fecha.h"
+
+int main()
+{
+	
+	unsigned int errores = 0;
+	char texto[32];
+	
+	unsigned int prueba;
+	for( prueba = 0 ; prueba < 100000 ; prueba++ )
+	{
+		
+		///Comparo contra timegm, con y sin ceros a la izquierda; un día
+		///que el mes no tiene no es una fecha
+		struct tm t;
+		memset( &t , 0 , sizeof( t ) );
+		t.tm_year = 1900 + rand() % 300 - 1900;
+		t.tm_mon = rand() % 12;
+		t.tm_mday = 1 + rand() % 31;
+		t.tm_hour = rand() % 24;
+		t.tm_min = rand() % 60;
+		t.tm_sec = prueba % 3 == 2 ? rand() % 60 : 0;
+		char * formatos[] = { "%02d/%02d/%04d %02d:%02d,1" ,
+							  "%d/%d/%d %d:%02d" ,
+							  "%02d/%02d/%04d %02d:%02d:%02d" };
+		char * formato = formatos[prueba % 3];
+		snprintf( texto , sizeof( texto ) , formato ,
+				  t.tm_mday , t.tm_mon + 1 , t.tm_year + 1900 ,
+				  t.tm_hour , t.tm_min , t.tm_sec );
+		
+		struct tm normalizada = t;
+		time_t esperados = timegm( &normalizada );
+		int existe = normalizada.tm_mday == t.tm_mday;
+		int64_t segundos;
+		vista fecha = String_Vista_de_cadena( texto );
+		if( !existe )
+		{
+			
+			if( Fecha_Leer( fecha , &segundos ) )
+			{
+				
+				printf( "\n Error: se aceptó \"%s\"" , texto );
+				errores++;
+				
+			}
+			continue;
+			
+		}
+		if( !Fecha_Leer( fecha , &segundos ) ||
+			segundos != (int64_t)esperados )
+		{
+			
+			printf( "\n Error al leer \"%s\"" , texto );
+			errores++;
+			continue;
+			
+		}
+		
+		///Ida y vuelta de las claves de día y de mes
+		char dia[FECHA_LARGO_CADENA];
+		char esperado[FECHA_LARGO_CADENA];
+		Fecha_Dia_a_cadena( Fecha_Dia( segundos ) , dia );
+		snprintf( esperado , sizeof( esperado ) , "%02d/%02d/%04d" ,
+				  t.tm_mday , t.tm_mon + 1 , t.tm_year + 1900 );
+		if( strcmp( dia , esperado ) != 0 )
+			errores++;
+		Fecha_Mes_a_cadena( Fecha_Mes( Fecha_Dia( segundos ) ) , dia );
+		if( strcmp( dia , esperado + 3 ) != 0 )
+			errores++;
+		if( (int64_t)Fecha_Hora( segundos ) * 3600 !=
+			segundos - t.tm_min * 60 - t.tm_sec )
+			errores++;
+		
+		///Escritura de la marca completa y lectura del día solo
+		char completa[FECHA_LARGO_CADENA];
+		Fecha_Tiempo_a_cadena( segundos , completa );
+		snprintf( esperado , sizeof( esperado ) ,
+				  t.tm_sec == 0 ? "%02d/%02d/%04d %02d:%02d" :
+								  "%02d/%02d/%04d %02d:%02d:%02d" ,
+				  t.tm_mday , t.tm_mon + 1 , t.tm_year + 1900 ,
+				  t.tm_hour , t.tm_min , t.tm_sec );
+		if( strcmp( completa , esperado ) != 0 )
+			errores++;
+		long int clave;
+		completa[10] = '\0';
+		if( !Fecha_Leer_dia( String_Vista_de_cadena( completa ) ,
+							 &clave ) ||
+			clave != Fecha_Dia( segundos ) )
+			errores++;
+		
+	}
+	
+	char * invalidas[] = { "" , "28/07/2016" , "32/07/2016 10:00" ,
+						   "28/13/2016 10:00" , "28/07/2016 24:00" ,
+						   "2x/07/2016 10:00" , "28-07-2016 10:00" ,
+						   "28/07/2016 10:" , "--" };
+	unsigned int cantidad = sizeof( invalidas ) / sizeof( char * );
+	unsigned int pos;
+	for( pos = 0 ; pos < cantidad ; pos++ )
+	{
+		
+		int64_t segundos;
+		if( Fecha_Leer( String_Vista_de_cadena( invalidas[pos] ) ,
+						&segundos ) )
+		{
+			
+			printf( "\n Error: se aceptó \"%s\"" , invalidas[pos] );
+			errores++;
+			
+		}
+		
+	}
+	
+	char * dias_invalidos[] = { "" , "28/07/2016 10:00" , "0/07/2016" ,
+								"28/13/2016" , "28/07/" , "28/07" ,
+								"31/02/2016" , "29/02/2017" ,
+								"29/02/1900" , "31/04/2016" };
+	cantidad = sizeof( dias_invalidos ) / sizeof( char * );
+	for( pos = 0 ; pos < cantidad ; pos++ )
+	{
+		
+		long int dia;
+		vista texto = String_Vista_de_cadena( dias_invalidos[pos] );
+		if( Fecha_Leer_dia( texto , &dia ) )
+		{
+			
+			printf( "\n Error: se aceptó \"%s\"" ,
+					dias_invalidos[pos] );
+			errores++;
+			
+		}
+		
+	}
+	
+	///Las mismas fechas agregadas a una cadena que crece
+	cadena_creciente c;
+	String_Creciente_Iniciar( &c , 0 );
+	Fecha_Agregar_dia( &c , 17010 );
+	String_Agregar_caracter( &c , ' ' );
+	Fecha_Agregar_mes( &c , Fecha_Mes( 17010 ) );
+	String_Agregar_caracter( &c , ' ' );
+	Fecha_Agregar_tiempo( &c , (int64_t)17010 * 86400 + 600 );
+	if( strcmp( c.texto , "28/07/2016 07/2016 28/07/2016 00:10" ) != 0 )
+		errores++;
+	Mem_desassign( (void **)&c.texto );
+	
+	printf( "\n errores = %u\n" , errores );
+	
+	return errores != 0;
+	
+}
@@ -14,8 +14,26 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <fcntl.h> //open
+#include <unistd.h> //close , pread
+#include <sys/mman.h> //mmap , munmap
+#include <sys/stat.h> //fstat
+#include <sys/inotify.h> //inotify_init1
+#include <poll.h> //poll
 
 #include "Mem.h"
+#include "Simd.h"
+
+///Archivo mapeado en memoria para leerlo sin copias
+typedef struct {
+	
+	char * data; /// contenido del archivo (solo lectura)
+	long unsigned int size;
+	long unsigned int capacity; /// direcciones reservadas para crecer
+	long unsigned int position; /// inicio de la próxima línea
+	int fd;
+	
+} file_map;
 
 /**
  * @brief Cantidad de caracteres en un archivo
@@ -61,22 +79,26 @@ int File_position_next_character( FILE * file , char character )
 	
 	fgetpos( file , &position_backup );
 	
+	///Lee por bloques y busca con Simd_Buscar en lugar de fgetc
+	char set[2] = { character , '\0' };
+	char block[4096];
 	int result = 0;
-	char ch;
+	size_t read;
 	
-	while( ( ch = fgetc(file) ) != EOF )
+	while( ( read = fread( block , 1 , sizeof( block ) , file ) ) > 0 )
 	{
 		
-		if( ch == character )
+		const char * found = Simd_Buscar( block , read , set );
+		if( found != NULL )
 		{
 			
 			fsetpos( file , &position_backup );
 			
-			return result;
+			return result + ( found - block );
 			
 		}
 		
-		result++;
+		result += read;
 		
 	}
 	
@@ -123,32 +145,21 @@ char * File_read_until_next_ocurrence_char_FREE( FILE * file , char c )
 	if( file == NULL )
 		return NULL;
 	
-	int copy_size = File_position_next_character( file , c );
-	
-	if( copy_size < 0 )
-	{
-		
-		copy_size = copy_size * -1;
-		
-		c = EOF;
-		
-	} 
-	
-	char * copy = (char *)Mem_assign( (copy_size + 1) * sizeof(char) );
+	///Una sola pasada: getdelim copia hasta 'c' (incluido) o EOF
+	char * copy = NULL;
+	size_t copy_size = 0;
+	ssize_t read = getdelim( &copy , &copy_size , c , file );
 	
-	char ch;
-	int pos = 0;
-	while( ( ch = fgetc(file) ) != c )
+	if( read < 0 )
 	{
 		
-		copy[pos] = ch;
-		
-		pos++;
+		free( copy );
+		return Mem_Create_string( 0 );
 		
 	}
-
-	copy[pos] = '\0';
 	
+	if( read > 0 && copy[read - 1] == c )
+		copy[read - 1] = '\0';
 	
 	return copy;
 	
@@ -168,4 +179,315 @@ char * File_read_current_line_FREE( FILE * file )
 	
 }
 
+/**
+ * \brief Mapea un archivo completo en memoria de solo lectura,
+ * reservando direcciones para que pueda crecer sin moverse (los
+ * punteros a sus datos siguen siendo válidos)
+ *
+ * \param path Ruta del archivo
+ * \param capacity Tamaño máximo al que puede crecer el mapeo; si es
+ * menor que el archivo solo se mapea el archivo
+ *
+ * \return Archivo mapeado (posición al inicio) o NULL en caso de error
+ */
+file_map * File_map_open_reserved
+( char * path , long unsigned int capacity )
+{
+	
+	int fd = open( path , O_RDONLY );
+		if( fd < 0 )
+			return NULL;
+	
+	struct stat info;
+		if( fstat( fd , &info ) < 0 )
+		{
+			
+			close( fd );
+			return NULL;
+			
+		}
+	
+	file_map * map = (file_map *)Mem_assign( sizeof( file_map ) );
+	map->fd = fd;
+	map->size = info.st_size;
+	map->capacity = capacity > map->size ? capacity : map->size;
+	map->position = 0;
+	map->data = NULL;
+	
+	if( map->capacity == 0 )
+		return map;
+	
+	///Reservo las direcciones sin memoria y mapeo el archivo al inicio
+	void * reserve = MAP_FAILED;
+	if( map->capacity > map->size )
+		reserve = mmap( NULL ,
+						map->capacity ,
+						PROT_NONE ,
+						MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE ,
+						-1 ,
+						0 );
+	if( reserve == MAP_FAILED )
+		map->capacity = map->size;
+	
+	map->data = reserve == MAP_FAILED ? NULL : reserve;
+	if( map->size > 0 )
+	{
+		
+		map->data = mmap( reserve == MAP_FAILED ? NULL : reserve ,
+						  map->size ,
+						  PROT_READ ,
+						  MAP_PRIVATE |
+						  ( reserve == MAP_FAILED ? 0 : MAP_FIXED ) ,
+						  fd ,
+						  0 );
+		if( map->data == MAP_FAILED )
+		{
+			
+			if( reserve != MAP_FAILED )
+				munmap( reserve , map->capacity );
+			close( fd );
+			Mem_desassign( (void **)&map );
+			return NULL;
+			
+		}
+		
+	}
+	
+	///Se recorre de principio a fin
+	if( map->size > 0 )
+		madvise( map->data , map->size , MADV_SEQUENTIAL );
+	
+	return map;
+	
+}
+
+/**
+ * \brief Mapea un archivo completo en memoria de solo lectura
+ *
+ * \see File_map_open_reserved
+ */
+file_map * File_map_open( char * path )
+{
+	
+	return File_map_open_reserved( path , 0 );
+	
+}
+
+/**
+ * \brief Extiende el mapeo si el archivo creció, en las mismas
+ * direcciones (solo se mapean las páginas nuevas)
+ *
+ * \return bytes agregados, 0 si no creció o -1 si se achicó o superó
+ * la capacidad reservada
+ */
+long int File_map_grow( file_map * map )
+{
+	
+	struct stat info;
+		if( map == NULL || fstat( map->fd , &info ) < 0 ||
+			info.st_size < 0 )
+			return -1;
+	
+	long unsigned int size = info.st_size;
+		if( size < map->size )
+			return -1;
+		if( size == map->size )
+			return 0;
+		if( size > map->capacity || map->data == NULL )
+			return -1;
+	
+	long unsigned int page = sysconf( _SC_PAGESIZE );
+	long unsigned int offset = map->size / page * page;
+	void * data = mmap( map->data + offset ,
+						size - offset ,
+						PROT_READ ,
+						MAP_PRIVATE | MAP_FIXED ,
+						map->fd ,
+						offset );
+		if( data == MAP_FAILED )
+			return -1;
+	
+	long int grown = size - map->size;
+	map->size = size;
+	
+	return grown;
+	
+}
+
+/**
+ * \brief Indica si la ruta sigue siendo el archivo mapeado (no fue
+ * reemplazada por otro archivo, ni movida o borrada)
+ *
+ * \return 1 si es el mismo archivo o 0 si no
+ */
+int File_map_is( file_map * map , char * path )
+{
+	
+	struct stat mapped;
+	struct stat current;
+		if( map == NULL || fstat( map->fd , &mapped ) < 0 )
+			return 0;
+		if( stat( path , &current ) < 0 )
+			return 0;
+	
+	return mapped.st_dev == current.st_dev &&
+		   mapped.st_ino == current.st_ino;
+	
+}
+
+/**
+ * \brief Copia bytes del archivo mapeado leyéndolos del descriptor y
+ * no del mapeo: si el archivo se acortó la lectura queda corta en
+ * lugar de fallar al tocar una página que ya no existe
+ *
+ * \return 0 o -1 si el archivo ya no tiene esos bytes
+ */
+int File_map_read( file_map * map , long unsigned int offset ,
+				   char * buffer , long unsigned int size )
+{
+	
+	while( size > 0 )
+	{
+		
+		ssize_t count = pread( map->fd , buffer , size , offset );
+			if( count <= 0 )
+				return -1;
+		buffer += count;
+		offset += count;
+		size -= count;
+		
+	}
+	
+	return 0;
+	
+}
+
+void File_map_close( file_map ** map )
+{
+	
+	if( *map == NULL )
+		return;
+	
+	if( (*map)->data != NULL )
+		munmap( (*map)->data , (*map)->capacity );
+	close( (*map)->fd );
+	
+	Mem_desassign( (void **)map );
+	
+}
+
+/**
+ * \brief Vigila los cambios de un archivo (inotify), sin bloquear
+ *
+ * \return descriptor de la vigilancia o -1 en caso de error
+ */
+int File_watch_open( char * path )
+{
+	
+	int fd = inotify_init1( IN_NONBLOCK | IN_CLOEXEC );
+		if( fd < 0 )
+			return -1;
+	
+	uint32_t mask = IN_MODIFY | IN_ATTRIB;
+	mask |= IN_MOVE_SELF | IN_DELETE_SELF;
+	if( inotify_add_watch( fd , path , mask ) < 0 )
+	{
+		
+		close( fd );
+		return -1;
+		
+	}
+	
+	return fd;
+	
+}
+
+/**
+ * \brief Consume los eventos pendientes de la vigilancia sin bloquear
+ *
+ * \return eventos ocurridos (IN_MODIFY, etc) o 0 si no hubo ninguno
+ */
+unsigned int File_watch_events( int watch )
+{
+	
+	struct inotify_event * event;
+	char buffer[4096] __attribute__(( aligned( 8 ) ));
+	unsigned int events = 0;
+	ssize_t length;
+	while( ( length = read( watch , buffer , sizeof( buffer ) ) ) > 0 )
+	{
+		
+		ssize_t position = 0;
+		while( position < length )
+		{
+			
+			event = (struct inotify_event *)&buffer[position];
+			events |= event->mask;
+			position += sizeof( struct inotify_event ) + event->len;
+			
+		}
+		
+	}
+	
+	return events;
+	
+}
+
+/**
+ * \brief Indica si hay eventos pendientes sin consumirlos: varios hilos
+ * pueden consultarlo a la vez, a diferencia de File_watch_events
+ */
+int File_watch_pending( int watch )
+{
+	
+	struct pollfd descriptor = { watch , POLLIN , 0 };
+	
+	return poll( &descriptor , 1 , 0 ) > 0;
+	
+}
+
+/**
+ * \brief Entrega la siguiente línea del archivo mapeado, sin copiarla:
+ * un puntero a su inicio y su largo sin contar el caractere 'c'. Avanza
+ * la posición a la línea siguiente
+ *
+ * \param map Archivo mapeado
+ * \param c Caractere (simbolo ASCII) que termina cada línea
+ * \param line Para guardar el inicio de la línea
+ * \param length Para guardar el largo de la línea
+ *
+ * \return 1 si entregó una línea o 0 al llegar al final del archivo
+ */
+int File_map_next_line
+( file_map * map , char c , char ** line , long unsigned int * length )
+{
+	
+	if( map == NULL || map->position >= map->size )
+		return 0;
+	
+	char set[2] = { c , '\0' };
+	char * start = &map->data[map->position];
+	long unsigned int left = map->size - map->position;
+	char * end = (char *)Simd_Buscar( start , left , set );
+	
+	*line = start;
+	if( end == NULL )
+	{
+		
+		*length = left;
+		map->position = map->size;
+		
+	}
+	else
+	{
+		
+		*length = end - start;
+		map->position += *length + 1;
+		
+	}
+	
+	return 1;
+	
+}
+
 #endif
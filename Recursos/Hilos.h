@@ -0,0 +1,150 @@
+/**
+ * @author Fernández Nicolás (nicofernandez@alumnos.unc.edu.ar)
+ * @date Mayo, 2017
+ * @version 0.5.2017 beta
+ *
+ * @brief Reparto de un rango de trabajo entre varios hilos (pthreads,
+ * compilar con -pthread): cada hilo recibe un tramo contiguo y su
+ * número para escribir resultados parciales sin sincronizarse
+ *
+ * \file Hilos.h
+ */
+
+#ifndef HILOS_H
+#define HILOS_H
+
+#include <pthread.h>
+#include <unistd.h> //sysconf
+
+#define HILOS_MAXIMO 64
+
+/**
+ * @brief Tarea de un hilo sobre el tramo [inicio , fin) del trabajo
+ *
+ * @param contexto : datos compartidos por todos los hilos
+ * @param hilo : número del hilo, de 0 a la cantidad de hilos - 1
+ */
+typedef void ( * hilos_tarea )( void * contexto ,
+								unsigned int hilo ,
+								long unsigned int inicio ,
+								long unsigned int fin );
+
+typedef struct {
+	
+	hilos_tarea tarea;
+	void * contexto;
+	unsigned int hilo;
+	long unsigned int inicio;
+	long unsigned int fin;
+	
+} hilos_tramo;
+
+/**
+ * @brief Procesadores disponibles, entre 1 y HILOS_MAXIMO
+ */
+unsigned int Hilos_Cantidad( )
+{
+	
+	long procesadores = sysconf( _SC_NPROCESSORS_ONLN );
+		if( procesadores < 1 )
+			return 1;
+		if( procesadores > HILOS_MAXIMO )
+			return HILOS_MAXIMO;
+	
+	return procesadores;
+	
+}
+
+/**
+ * @brief Cantidad de hilos para un trabajo, de forma que a cada uno le
+ * toquen al menos 'minimo' elementos
+ */
+unsigned int Hilos_Para( long unsigned int total ,
+						 long unsigned int minimo )
+{
+	
+	unsigned int hilos = Hilos_Cantidad( );
+	if( minimo > 0 && total / minimo < hilos )
+		hilos = total / minimo;
+	
+	return hilos > 0 ? hilos : 1;
+	
+}
+
+void * Hilos_Ejecutar( void * argumento )
+{
+	
+	hilos_tramo * tramo = argumento;
+	tramo->tarea( tramo->contexto ,
+				  tramo->hilo ,
+				  tramo->inicio ,
+				  tramo->fin );
+	
+	return NULL;
+	
+}
+
+/**
+ * @brief Divide [0 , total) en tramos contiguos y ejecuta la tarea en
+ * paralelo, uno por hilo; el último tramo lo procesa el hilo que
+ * llama. Si no se puede crear un hilo su tramo se procesa en el que
+ * llama, por lo que el trabajo siempre se completa
+ *
+ * @param hilos : cantidad de tramos (1 a HILOS_MAXIMO)
+ * @return cantidad de hilos creados
+ */
+unsigned int Hilos_Repartir( long unsigned int total ,
+							 unsigned int hilos ,
+							 hilos_tarea tarea ,
+							 void * contexto )
+{
+	
+		if( hilos < 1 )
+			hilos = 1;
+		if( hilos > HILOS_MAXIMO )
+			hilos = HILOS_MAXIMO;
+	
+	pthread_t ids[HILOS_MAXIMO];
+	hilos_tramo tramos[HILOS_MAXIMO];
+	int creado[HILOS_MAXIMO];
+	unsigned int creados = 0;
+	
+	unsigned int hilo;
+	for( hilo = 0 ; hilo < hilos ; hilo++ )
+	{
+		
+		tramos[hilo].tarea = tarea;
+		tramos[hilo].contexto = contexto;
+		tramos[hilo].hilo = hilo;
+		tramos[hilo].inicio = total / hilos * hilo;
+		tramos[hilo].fin = hilo + 1 == hilos ?
+						   total :
+						   total / hilos * ( hilo + 1 );
+		creado[hilo] = 0;
+		if( hilo + 1 < hilos &&
+			pthread_create( &ids[hilo] ,
+							NULL ,
+							Hilos_Ejecutar ,
+							&tramos[hilo] ) == 0 )
+		{
+			
+			creado[hilo] = 1;
+			creados++;
+			
+		}
+		
+	}
+	
+	for( hilo = 0 ; hilo < hilos ; hilo++ )
+		if( !creado[hilo] )
+			Hilos_Ejecutar( &tramos[hilo] );
+	
+	for( hilo = 0 ; hilo < hilos ; hilo++ )
+		if( creado[hilo] )
+			pthread_join( ids[hilo] , NULL );
+	
+	return creados;
+	
+}
+
+#endif
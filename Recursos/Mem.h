@@ -3,7 +3,7 @@
  * @date Mayo, 2017
  * @version 0.5.2017 beta
  *
- * @brief Manejo de memoria, uso de las funciones malloc y free
+ * @brief Manejo de memoria, uso de las funciones malloc y free
  * para crear y liberar matrices
  *
  * \file Mem.h
@@ -18,12 +18,20 @@
 
 #define TEST_MEM_H 1
 
+///Alineación de los datos de una matriz (una línea de cache)
+#define MEM_MATRIX_ALIGN 64
+
+///Orden de los elementos de una matriz en su bloque
+typedef enum { MEM_ROW_MAJOR , MEM_COLUMN_MAJOR } mem_layout;
+
 typedef struct {
 	
-	void ** m;
+	void ** m; /// filas (o columnas, si es MEM_COLUMN_MAJOR)
+	void * data; /// todos los elementos seguidos, alineados
 	long unsigned int rows;
 	long unsigned int columns;
 	size_t type_size;
+	mem_layout layout;
 	
 } matrix;
 
@@ -76,6 +84,51 @@ void * Mem_assign_vector_zeros( size_t rows , size_t type_size )
 	
 }
 
+/**
+ * @brief Reasigna memoria mediante realloc y comprueba, en caso de
+ * fallar advierte y cierrra el programa
+ *
+ * @param p memoria a reasignar (o NULL)
+ * @param s nueva cantidad
+ *
+ * @return el retorno de realloc( p , s )
+ */
+void * Mem_reassign( void * p , size_t s )
+{
+	
+	void * ptr = realloc( p , s );
+	
+	if( ptr != NULL || s == 0 )
+		return ptr;
+	
+	printf( "\n --- MEMORY ASSIGNMENT FAULT ---  \n" );
+	exit( 1 );
+	
+}
+
+/**
+ * @brief Agranda un vector al menos al doble cuando no le entran
+ * 'needed' bytes: agregar al final cuesta O(1) amortizado
+ *
+ * @param allocated bytes asignados, se actualiza
+ *
+ * @return el vector, quizás movido
+ */
+void * Mem_grow( void * p , size_t * allocated , size_t needed )
+{
+	
+	if( needed <= *allocated )
+		return p;
+	
+	size_t s = *allocated * 2 + 64;
+	if( s < needed )
+		s = needed;
+	*allocated = s;
+	
+	return Mem_reassign( p , s );
+	
+}
+
 /**
  * @brief Libera la memoria mediante free y apunta a null
  *
@@ -104,46 +157,115 @@ void * Mem_assign_vector( unsigned int rows , size_t type_size )
 	
 }
 
-void ** Mem_assign_matrix
-( unsigned int rows , unsigned int columns , size_t type_size )
+/**
+ * @brief Asigna en un solo bloque alineado a MEM_MATRIX_ALIGN los
+ * punteros a cada línea y, a continuación, los datos de todas las
+ * líneas seguidas: recorrer la matriz es recorrer memoria contigua
+ *
+ * @param data : si no es NULL, recibe el comienzo de los datos
+ *
+ * @return punteros a las líneas, se libera con un solo free
+ */
+void ** Mem_assign_lines( unsigned int lines , size_t line_size ,
+						  void ** data )
 {
 	
-	void ** p_p = (void **)Mem_assign( rows * sizeof(void *) );
-	unsigned int row;
-	for( row = 0 ; row < rows ; row++ )
-		p_p[row] = Mem_assign( columns * type_size );
+	size_t pointers = (size_t)lines * sizeof( void * );
+	pointers = ( pointers + MEM_MATRIX_ALIGN - 1 ) &
+			   ~(size_t)( MEM_MATRIX_ALIGN - 1 );
+	void * block = NULL;
+	if( posix_memalign( &block , MEM_MATRIX_ALIGN ,
+						pointers + (size_t)lines * line_size ) != 0 )
+	{
+		
+		printf( "\n --- MEMORY ASSIGNMENT FAULT ---  \n" );
+		exit( 1 );
+		
+	}
+	
+	void ** p_p = block;
+	char * first = (char *)block + pointers;
+	unsigned int line;
+	for( line = 0 ; line < lines ; line++ )
+		p_p[line] = first + (size_t)line * line_size;
+	if( data != NULL )
+		*data = first;
 	
 	return p_p;
 	
-}
+}
 
-void Mem_desassign_matrix( void *** matrx , unsigned int rows )
+///Filas contiguas, p_p[row][column] como siempre
+void ** Mem_assign_matrix
+( unsigned int rows , unsigned int columns , size_t type_size )
 {
 	
-	unsigned int row;
-	for( row = 0 ; row < rows ; row++ )
-		Mem_desassign( (void *)&( (*matrx)[row] ) );
+	return Mem_assign_lines( rows , columns * type_size , NULL );
+	
+}
+
+/**
+ * @param rows : sin uso desde que la matriz es un solo bloque, se
+ * mantiene por compatibilidad
+ */
+void Mem_desassign_matrix( void *** matrx , unsigned int rows )
+{
 	
-	Mem_desassign( *matrx );
+	(void)rows;
+	Mem_desassign( (void **)matrx );
 	
 }
 
-matrix * Mem_Create_matrix
-( unsigned int rows , unsigned int columns , size_t type_size )
+/**
+ * @brief Matriz en un bloque contiguo: por filas, m->m[row][column];
+ * por columnas, m->m[column][row]. Mem_Matrix_element sirve en ambos
+ */
+matrix * Mem_Create_matrix_layout( unsigned int rows ,
+								   unsigned int columns ,
+								   size_t type_size ,
+								   mem_layout layout )
 {
 	
 	matrix * m = Mem_assign( sizeof(matrix) );
 	
-	m->m = Mem_assign_matrix( rows , columns , type_size );
+	if( layout == MEM_ROW_MAJOR )
+		m->m = Mem_assign_lines( rows , columns * type_size ,
+								 &m->data );
+	else
+		m->m = Mem_assign_lines( columns , rows * type_size ,
+								 &m->data );
 	
 	m->rows = rows;
 	m->columns = columns;
 	m->type_size = type_size;
+	m->layout = layout;
 	
 	return m;
 	
 }
 
+matrix * Mem_Create_matrix
+( unsigned int rows , unsigned int columns , size_t type_size )
+{
+	
+	return Mem_Create_matrix_layout( rows , columns , type_size ,
+									 MEM_ROW_MAJOR );
+	
+}
+
+///Dirección del elemento ( row , column ) sea cual sea el orden
+void * Mem_Matrix_element( matrix * m , long unsigned int row ,
+						   long unsigned int column )
+{
+	
+	size_t pos = m->layout == MEM_ROW_MAJOR ?
+				 row * m->columns + column :
+				 column * m->rows + row;
+	
+	return (char *)m->data + pos * m->type_size;
+	
+}
+
 void Mem_Delete_matrix( matrix ** m )
 {
 	
@@ -229,14 +351,19 @@ char * Mem_Copy_text_into_string_and_delete_text( text ** t )
 	
 	char * rtrn = Mem_Create_string( length );
 	
+	///Copio cada parte a continuación de la anterior, sin strcat
+	char * end = rtrn;
 	unsigned long int part;
 	for( part = 0 ; part < (*t)->parts ; part++ )
 	{
 		
-		strcat( rtrn , (*t)->t[part] );
+		size_t part_length = strlen( (*t)->t[part] );
+		memcpy( end , (*t)->t[part] , part_length );
+		end += part_length;
 		Mem_desassign( (void **)&((*t)->t[part]) );
 		
 	}
+	*end = '\0';
 	
 	Mem_desassign( (void **)&((*t)->t) );
 	Mem_desassign( (void **)t );
@@ -245,6 +372,192 @@ char * Mem_Copy_text_into_string_and_delete_text( text ** t )
 	
 }
 
+///Alineación de lo asignado en un área (la de malloc en x86-64)
+#define MEM_ARENA_ALIGN 16
+///Bloques que puede llegar a ocupar el primero al vaciar el área
+#define MEM_ARENA_KEEP 16
+
+///Bloque de un área: se asigna desde el final de lo usado
+typedef struct arena_block {
+	
+	struct arena_block * next;
+	size_t size;
+	size_t used;
+	char data[] __attribute__(( aligned( MEM_ARENA_ALIGN ) ));
+	
+} arena_block;
+
+/**
+ * Área de memoria (arena): asignar es avanzar un índice y todo se
+ * libera junto con Mem_Arena_reset. Sirve para lo que dura un mismo
+ * pedido, sin un malloc y un free por cada parte
+ */
+typedef struct {
+	
+	arena_block * first; /// se conserva al vaciar
+	arena_block * current;
+	size_t block_size;
+	void * last; /// última asignación: puede crecer en su lugar
+	size_t last_size;
+	
+} arena;
+
+arena_block * Mem_Arena_block( size_t size )
+{
+	
+	arena_block * b = Mem_assign( sizeof( arena_block ) + size );
+	b->next = NULL;
+	b->size = size;
+	b->used = 0;
+	
+	return b;
+	
+}
+
+/**
+ * @param block_size tamaño de cada bloque (los pedidos mayores tienen
+ * uno propio)
+ */
+arena * Mem_Arena_create( size_t block_size )
+{
+	
+	arena * a = Mem_assign( sizeof( arena ) );
+	a->block_size = block_size;
+	a->first = Mem_Arena_block( block_size );
+	a->current = a->first;
+	a->last = NULL;
+	a->last_size = 0;
+	
+	return a;
+	
+}
+
+/**
+ * @brief Asigna 's' bytes alineados a MEM_ARENA_ALIGN, que se liberan
+ * con el resto del área
+ */
+void * Mem_Arena_assign( arena * a , size_t s )
+{
+	
+	size_t aligned = ( s + MEM_ARENA_ALIGN - 1 ) &
+					 ~(size_t)( MEM_ARENA_ALIGN - 1 );
+	arena_block * b = a->current;
+	if( b->used + aligned > b->size )
+	{
+		
+		b = Mem_Arena_block( aligned > a->block_size ? aligned :
+													   a->block_size );
+		a->current->next = b;
+		a->current = b;
+		
+	}
+	
+	void * ptr = &b->data[b->used];
+	b->used += aligned;
+	a->last = ptr;
+	a->last_size = aligned;
+	
+	return ptr;
+	
+}
+
+/**
+ * @brief Como Mem_reassign dentro del área: la última asignación crece
+ * en su lugar si entra en el bloque; si no, se copia a una nueva
+ *
+ * @param old_size bytes de 'p' a conservar
+ */
+void * Mem_Arena_reassign( arena * a , void * p , size_t old_size ,
+						   size_t s )
+{
+	
+	if( p != NULL && p == a->last )
+	{
+		
+		arena_block * b = a->current;
+		size_t start = (char *)p - b->data;
+		size_t aligned = ( s + MEM_ARENA_ALIGN - 1 ) &
+						 ~(size_t)( MEM_ARENA_ALIGN - 1 );
+		if( start + aligned <= b->size )
+		{
+			
+			b->used = start + aligned;
+			a->last_size = aligned;
+			return p;
+			
+		}
+		
+	}
+	
+	void * ptr = Mem_Arena_assign( a , s );
+	if( p != NULL )
+		memcpy( ptr , p , old_size < s ? old_size : s );
+	
+	return ptr;
+	
+}
+
+char * Mem_Arena_create_string( arena * a , long unsigned int length )
+{
+	
+	char * rtrn = Mem_Arena_assign( a , length + 1 );
+	rtrn[0] = '\0';
+	rtrn[length] = '\0';
+	
+	return rtrn;
+	
+}
+
+/**
+ * @brief Libera todo lo asignado en el área. Si hicieron falta más
+ * bloques, el primero se agranda a lo que ocupaban todos: un pedido
+ * parecido al siguiente no vuelve a llamar a malloc. No pasa de
+ * MEM_ARENA_KEEP bloques, para no retener lo de un pedido enorme
+ */
+void Mem_Arena_reset( arena * a )
+{
+	
+	size_t total = 0;
+	arena_block * b = a->first->next;
+	while( b != NULL )
+	{
+		
+		arena_block * next = b->next;
+		total += b->size;
+		free( b );
+		b = next;
+		
+	}
+	
+	size_t keep = a->block_size * MEM_ARENA_KEEP;
+	if( total > 0 )
+		total += a->first->size;
+	if( total > keep )
+		total = keep;
+	if( total > 0 && total != a->first->size )
+	{
+		
+		free( a->first );
+		a->first = Mem_Arena_block( total );
+		
+	}
+	a->first->used = 0;
+	a->first->next = NULL;
+	a->current = a->first;
+	a->last = NULL;
+	a->last_size = 0;
+	
+}
+
+void Mem_Arena_delete( arena ** a )
+{
+	
+	Mem_Arena_reset( *a );
+	free( (*a)->first );
+	Mem_desassign( (void **)a );
+	
+}
+
 #if TEST_MEM_H
 #include "Print.h"
 
@@ -330,6 +643,60 @@ void Mem_Test_Struct_Matrix( )
 	
 }
 
+unsigned int Mem_Test_Matrix_layout( )
+{
+	
+	unsigned int errors = 0;
+	unsigned int repetition;
+	for( repetition = 0 ; repetition < 1000 ; repetition++ )
+	{
+		
+		unsigned int rows = rand() % 300 + 1;
+		unsigned int columns = rand() % 300 + 1;
+		mem_layout layout = rand() % 2 ? MEM_ROW_MAJOR :
+										 MEM_COLUMN_MAJOR;
+		matrix * m = Mem_Create_matrix_layout( rows , columns ,
+											   sizeof(double) ,
+											   layout );
+		if( (size_t)m->data % MEM_MATRIX_ALIGN != 0 )
+			errors++;
+		
+		///Por punteros o por posición es el mismo elemento
+		unsigned int row , column;
+		for( row = 0 ; row < rows ; row++ )
+			for( column = 0 ; column < columns ; column++ )
+				if( layout == MEM_ROW_MAJOR )
+					( (double **)m->m )[row][column] = row * 1000.0 +
+													   column;
+				else
+					( (double **)m->m )[column][row] = row * 1000.0 +
+													   column;
+		
+		///Todos seguidos, en el orden pedido
+		double * data = m->data;
+		for( row = 0 ; row < rows ; row++ )
+			for( column = 0 ; column < columns ; column++ )
+			{
+				
+				double * e = Mem_Matrix_element( m , row , column );
+				size_t pos = layout == MEM_ROW_MAJOR ?
+							 row * columns + column :
+							 column * rows + row;
+				if( *e != row * 1000.0 + column || e != &data[pos] )
+					errors++;
+				
+			}
+		
+		Mem_Delete_matrix( &m );
+		
+	}
+	
+	printf( "\n matrix errors = %u\n" , errors );
+	
+	return errors;
+	
+}
+
 void Mem_Test_Struct_Text( )
 {
 	
@@ -366,6 +733,65 @@ void Mem_Test_Struct_Text( )
 	
 }
 
+unsigned int Mem_Test_Arena( )
+{
+	
+	arena * a = Mem_Arena_create( 1024 );
+	unsigned int errors = 0;
+	
+	unsigned int repetition;
+	for( repetition = 0 ; repetition < 1000 ; repetition++ )
+	{
+		
+		///Partes al azar que no se pisan, alineadas
+		char * parts[64];
+		unsigned int sizes[64];
+		unsigned int part;
+		for( part = 0 ; part < 64 ; part++ )
+		{
+			
+			sizes[part] = rand() % 3000 + 1;
+			parts[part] = Mem_Arena_assign( a , sizes[part] );
+			memset( parts[part] , part , sizes[part] );
+			if( (size_t)parts[part] % MEM_ARENA_ALIGN != 0 )
+				errors++;
+			
+		}
+		
+		///La última crece en su lugar y conserva su contenido
+		char * grown = Mem_Arena_reassign( a , parts[63] , sizes[63] ,
+										   sizes[63] + 100 );
+		if( memcmp( grown , parts[63] , sizes[63] ) != 0 )
+			errors++;
+		
+		for( part = 0 ; part < 63 ; part++ )
+		{
+			
+			unsigned int pos;
+			for( pos = 0 ; pos < sizes[part] ; pos++ )
+				if( parts[part][pos] != (char)part )
+					errors++;
+			
+		}
+		Mem_Arena_reset( a );
+		
+	}
+	
+	if( a->first->next != NULL )
+		errors++;
+	
+	///Lo de un pedido enorme no queda retenido
+	Mem_Arena_assign( a , 1024 * MEM_ARENA_KEEP * 4 );
+	Mem_Arena_reset( a );
+	if( a->first->size > 1024 * MEM_ARENA_KEEP )
+		errors++;
+	Mem_Arena_delete( &a );
+	printf( "\n arena errors = %u\n" , errors );
+	
+	return errors;
+	
+}
+
 #endif
 
 #endif
@@ -0,0 +1,19 @@
+#include <stdio.h>
+#include <stdlib.h>		/* srand */
+
+#include "Mem.h"
+
+int main()
+{
+	
+	srand( 1 );
+	unsigned int errores = 0;
+	
+	errores += Mem_Test_Arena( );
+	errores += Mem_Test_Matrix_layout( );
+	
+	printf( "\n errores = %u\n" , errores );
+	
+	return errores != 0;
+	
+}
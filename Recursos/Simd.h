@@ -0,0 +1,529 @@
+/**
+ * @author Fernández Nicolás (nicofernandez@alumnos.unc.edu.ar)
+ * @date Mayo, 2017
+ * @version 0.5.2017 beta
+ *
+ * @brief Búsqueda vectorizada de separadores (CR, LF, ',', '|', ' ',
+ * etc) en cadenas y datos de archivos y suma de columnas de flotantes
+ * salteando los datos faltantes (NAN): SSE2 como base y AVX2 elegido
+ * al ejecutar si el procesador lo soporta
+ *
+ * \file Simd.h
+ */
+
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <stddef.h>
+#include <stdint.h> //uintptr_t
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__SSE2__)
+#include <immintrin.h>
+#define SIMD_X86 1
+#else
+#define SIMD_X86 0
+#endif
+
+///Las lecturas alineadas pueden pasar el fin de la cadena dentro de la
+///misma página: es seguro pero AddressSanitizer lo reporta
+#define SIMD_LECTURA_ALINEADA __attribute__(( no_sanitize_address ))
+
+///Cantidad máxima de caracteres distintos en un conjunto de búsqueda
+#define SIMD_MAX_CARACTERES 8
+
+/**
+ * @brief Indica si el procesador soporta AVX2 (se consulta una vez)
+ */
+int Simd_Usar_avx2( )
+{
+
+#if SIMD_X86
+	static int usar = -1;
+	if( usar < 0 )
+		usar = __builtin_cpu_supports( "avx2" ) ? 1 : 0;
+	return usar;
+#else
+	return 0;
+#endif
+
+}
+
+/**
+ * @brief Cantidad de caracteres del conjunto, hasta SIMD_MAX_CARACTERES
+ */
+unsigned int Simd_Largo_conjunto( const char * caracteres )
+{
+	
+	unsigned int largo = 0;
+	while( largo < SIMD_MAX_CARACTERES && caracteres[largo] != '\0' )
+		largo++;
+	
+	return largo;
+	
+}
+
+int Simd_Pertenece( char c , const char * caracteres , unsigned int n )
+{
+	
+	unsigned int pos;
+	for( pos = 0 ; pos < n ; pos++ )
+		if( c == caracteres[pos] )
+			return 1;
+	
+	return 0;
+	
+}
+
+const char * Simd_Buscar_escalar
+( const char * datos , size_t largo , const char * caracteres ,
+  unsigned int n )
+{
+	
+	size_t pos;
+	for( pos = 0 ; pos < largo ; pos++ )
+		if( Simd_Pertenece( datos[pos] , caracteres , n ) )
+			return &datos[pos];
+	
+	return NULL;
+	
+}
+
+/**
+ * @brief Suma los valores que no son NAN en doble precisión
+ *
+ * @param cantidad : para sumarle la cantidad de valores sumados
+ */
+double Simd_Sumar_escalar
+( const float * valores , size_t largo , size_t * cantidad )
+{
+	
+	double suma = 0;
+	size_t pos;
+	for( pos = 0 ; pos < largo ; pos++ )
+		if( !__builtin_isnan( valores[pos] ) )
+		{
+			
+			suma += valores[pos];
+			(*cantidad)++;
+			
+		}
+	
+	return suma;
+	
+}
+
+#if SIMD_X86
+
+/**
+ * @brief Máscara de bits (uno por byte) de las posiciones del bloque
+ * que coinciden con algún caractere del conjunto
+ */
+unsigned int Simd_Mascara_sse2
+( __m128i bloque , const __m128i * conjunto , unsigned int n )
+{
+	
+	__m128i coincidencias = _mm_cmpeq_epi8( bloque , conjunto[0] );
+	unsigned int pos;
+	for( pos = 1 ; pos < n ; pos++ )
+	{
+		
+		__m128i iguales = _mm_cmpeq_epi8( bloque , conjunto[pos] );
+		coincidencias = _mm_or_si128( coincidencias , iguales );
+		
+	}
+	
+	return _mm_movemask_epi8( coincidencias );
+	
+}
+
+const char * Simd_Buscar_sse2
+( const char * datos , size_t largo , const char * caracteres ,
+  unsigned int n )
+{
+	
+	__m128i conjunto[SIMD_MAX_CARACTERES];
+	unsigned int pos;
+	for( pos = 0 ; pos < n ; pos++ )
+		conjunto[pos] = _mm_set1_epi8( caracteres[pos] );
+	
+	size_t desde = 0;
+	for( ; desde + 16 <= largo ; desde += 16 )
+	{
+		
+		__m128i bloque;
+		bloque = _mm_loadu_si128( (const __m128i *)&datos[desde] );
+		unsigned int mascara;
+		mascara = Simd_Mascara_sse2( bloque , conjunto , n );
+		if( mascara != 0 )
+			return &datos[desde + __builtin_ctz( mascara )];
+		
+	}
+	
+	return Simd_Buscar_escalar( &datos[desde] ,
+								largo - desde ,
+								caracteres ,
+								n );
+	
+}
+
+size_t Simd_Contar_sse2
+( const char * datos , size_t largo , const char * caracteres ,
+  unsigned int n )
+{
+	
+	__m128i conjunto[SIMD_MAX_CARACTERES];
+	unsigned int pos;
+	for( pos = 0 ; pos < n ; pos++ )
+		conjunto[pos] = _mm_set1_epi8( caracteres[pos] );
+	
+	size_t cantidad = 0;
+	size_t desde = 0;
+	for( ; desde + 16 <= largo ; desde += 16 )
+	{
+		
+		__m128i bloque;
+		bloque = _mm_loadu_si128( (const __m128i *)&datos[desde] );
+		cantidad += __builtin_popcount( Simd_Mascara_sse2( bloque ,
+														   conjunto ,
+														   n ) );
+		
+	}
+	
+	for( ; desde < largo ; desde++ )
+		cantidad += Simd_Pertenece( datos[desde] , caracteres , n );
+	
+	return cantidad;
+	
+}
+
+/**
+ * @brief Recorre una cadena terminada en '\0' con lecturas alineadas a
+ * 16 bytes, que nunca cruzan a una página no asignada
+ */
+SIMD_LECTURA_ALINEADA
+const char * Simd_Buscar_en_cadena_sse2
+( const char * cadena , const char * caracteres , unsigned int n )
+{
+	
+	__m128i conjunto[SIMD_MAX_CARACTERES + 1];
+	unsigned int pos;
+	for( pos = 0 ; pos < n ; pos++ )
+		conjunto[pos] = _mm_set1_epi8( caracteres[pos] );
+	conjunto[n] = _mm_setzero_si128( );
+	
+	unsigned int desfase = (uintptr_t)cadena & 15;
+	const char * bloque = cadena - desfase;
+	unsigned int mascara;
+	mascara = Simd_Mascara_sse2(
+					_mm_load_si128( (const __m128i *)bloque ) ,
+					conjunto ,
+					n + 1 );
+	mascara &= ~0u << desfase;
+	
+	while( mascara == 0 )
+	{
+		
+		bloque += 16;
+		mascara = Simd_Mascara_sse2(
+						_mm_load_si128( (const __m128i *)bloque ) ,
+						conjunto ,
+						n + 1 );
+		
+	}
+	
+	return bloque + __builtin_ctz( mascara );
+	
+}
+
+/**
+ * @brief Suma de a 4 flotantes: los NAN se anulan con la máscara de
+ * comparación ordenada y se acumula en 2+2 dobles
+ */
+double Simd_Sumar_sse2
+( const float * valores , size_t largo , size_t * cantidad )
+{
+	
+	__m128d suma_baja = _mm_setzero_pd( );
+	__m128d suma_alta = _mm_setzero_pd( );
+	size_t validos = 0;
+	size_t desde = 0;
+	for( ; desde + 4 <= largo ; desde += 4 )
+	{
+		
+		__m128 bloque = _mm_loadu_ps( &valores[desde] );
+		__m128 mascara = _mm_cmpord_ps( bloque , bloque );
+		bloque = _mm_and_ps( bloque , mascara );
+		validos += __builtin_popcount( _mm_movemask_ps( mascara ) );
+		suma_baja = _mm_add_pd( suma_baja , _mm_cvtps_pd( bloque ) );
+		bloque = _mm_movehl_ps( bloque , bloque );
+		suma_alta = _mm_add_pd( suma_alta , _mm_cvtps_pd( bloque ) );
+		
+	}
+	
+	double partes[2];
+	_mm_storeu_pd( partes , _mm_add_pd( suma_baja , suma_alta ) );
+	*cantidad += validos;
+	
+	return partes[0] + partes[1] + Simd_Sumar_escalar( &valores[desde] ,
+													   largo - desde ,
+													   cantidad );
+	
+}
+
+__attribute__(( target( "avx2" ) ))
+unsigned int Simd_Mascara_avx2
+( __m256i bloque , const __m256i * conjunto , unsigned int n )
+{
+	
+	__m256i coincidencias = _mm256_cmpeq_epi8( bloque , conjunto[0] );
+	unsigned int pos;
+	for( pos = 1 ; pos < n ; pos++ )
+	{
+		
+		__m256i iguales = _mm256_cmpeq_epi8( bloque , conjunto[pos] );
+		coincidencias = _mm256_or_si256( coincidencias , iguales );
+		
+	}
+	
+	return (unsigned int)_mm256_movemask_epi8( coincidencias );
+	
+}
+
+__attribute__(( target( "avx2" ) ))
+const char * Simd_Buscar_avx2
+( const char * datos , size_t largo , const char * caracteres ,
+  unsigned int n )
+{
+	
+	__m256i conjunto[SIMD_MAX_CARACTERES];
+	unsigned int pos;
+	for( pos = 0 ; pos < n ; pos++ )
+		conjunto[pos] = _mm256_set1_epi8( caracteres[pos] );
+	
+	size_t desde = 0;
+	for( ; desde + 32 <= largo ; desde += 32 )
+	{
+		
+		__m256i bloque;
+		bloque = _mm256_loadu_si256( (const __m256i *)&datos[desde] );
+		unsigned int mascara;
+		mascara = Simd_Mascara_avx2( bloque , conjunto , n );
+		if( mascara != 0 )
+			return &datos[desde + __builtin_ctz( mascara )];
+		
+	}
+	
+	return Simd_Buscar_sse2( &datos[desde] ,
+							 largo - desde ,
+							 caracteres ,
+							 n );
+	
+}
+
+__attribute__(( target( "avx2" ) ))
+size_t Simd_Contar_avx2
+( const char * datos , size_t largo , const char * caracteres ,
+  unsigned int n )
+{
+	
+	__m256i conjunto[SIMD_MAX_CARACTERES];
+	unsigned int pos;
+	for( pos = 0 ; pos < n ; pos++ )
+		conjunto[pos] = _mm256_set1_epi8( caracteres[pos] );
+	
+	size_t cantidad = 0;
+	size_t desde = 0;
+	for( ; desde + 32 <= largo ; desde += 32 )
+	{
+		
+		__m256i bloque;
+		bloque = _mm256_loadu_si256( (const __m256i *)&datos[desde] );
+		cantidad += __builtin_popcount( Simd_Mascara_avx2( bloque ,
+														   conjunto ,
+														   n ) );
+		
+	}
+	
+	return cantidad + Simd_Contar_sse2( &datos[desde] ,
+										largo - desde ,
+										caracteres ,
+										n );
+	
+}
+
+__attribute__(( target( "avx2" ) )) SIMD_LECTURA_ALINEADA
+const char * Simd_Buscar_en_cadena_avx2
+( const char * cadena , const char * caracteres , unsigned int n )
+{
+	
+	__m256i conjunto[SIMD_MAX_CARACTERES + 1];
+	unsigned int pos;
+	for( pos = 0 ; pos < n ; pos++ )
+		conjunto[pos] = _mm256_set1_epi8( caracteres[pos] );
+	conjunto[n] = _mm256_setzero_si256( );
+	
+	unsigned int desfase = (uintptr_t)cadena & 31;
+	const char * bloque = cadena - desfase;
+	unsigned int mascara;
+	mascara = Simd_Mascara_avx2(
+					_mm256_load_si256( (const __m256i *)bloque ) ,
+					conjunto ,
+					n + 1 );
+	mascara &= ~0u << desfase;
+	
+	while( mascara == 0 )
+	{
+		
+		bloque += 32;
+		mascara = Simd_Mascara_avx2(
+						_mm256_load_si256( (const __m256i *)bloque ) ,
+						conjunto ,
+						n + 1 );
+		
+	}
+	
+	return bloque + __builtin_ctz( mascara );
+	
+}
+
+__attribute__(( target( "avx2" ) ))
+double Simd_Sumar_avx2
+( const float * valores , size_t largo , size_t * cantidad )
+{
+	
+	__m256d suma_baja = _mm256_setzero_pd( );
+	__m256d suma_alta = _mm256_setzero_pd( );
+	size_t validos = 0;
+	size_t desde = 0;
+	for( ; desde + 8 <= largo ; desde += 8 )
+	{
+		
+		__m256 bloque = _mm256_loadu_ps( &valores[desde] );
+		__m256 mascara = _mm256_cmp_ps( bloque , bloque , _CMP_ORD_Q );
+		bloque = _mm256_and_ps( bloque , mascara );
+		validos += __builtin_popcount( _mm256_movemask_ps( mascara ) );
+		__m256d mitad;
+		mitad = _mm256_cvtps_pd( _mm256_castps256_ps128( bloque ) );
+		suma_baja = _mm256_add_pd( suma_baja , mitad );
+		mitad = _mm256_cvtps_pd( _mm256_extractf128_ps( bloque , 1 ) );
+		suma_alta = _mm256_add_pd( suma_alta , mitad );
+		
+	}
+	
+	double partes[4];
+	_mm256_storeu_pd( partes , _mm256_add_pd( suma_baja , suma_alta ) );
+	*cantidad += validos;
+	
+	return partes[0] + partes[1] + partes[2] + partes[3]
+		   + Simd_Sumar_sse2( &valores[desde] ,
+							  largo - desde ,
+							  cantidad );
+	
+}
+
+#endif //SIMD_X86
+
+/**
+ * @brief Primer caractere de los datos que pertenece al conjunto
+ *
+ * @param datos : donde buscar (no necesita terminar en '\0')
+ * @param largo : cantidad de bytes a recorrer
+ * @param caracteres : conjunto de caracteres a buscar
+ * @return posición del caractere encontrado o NULL si no hay ninguno
+ */
+const char * Simd_Buscar
+( const char * datos , size_t largo , const char * caracteres )
+{
+	
+	unsigned int n = Simd_Largo_conjunto( caracteres );
+		if( n == 0 || datos == NULL )
+			return NULL;
+
+#if SIMD_X86
+	if( Simd_Usar_avx2( ) )
+		return Simd_Buscar_avx2( datos , largo , caracteres , n );
+	return Simd_Buscar_sse2( datos , largo , caracteres , n );
+#else
+	return Simd_Buscar_escalar( datos , largo , caracteres , n );
+#endif
+
+}
+
+/**
+ * @brief Cantidad de caracteres de los datos que pertenecen al conjunto
+ */
+size_t Simd_Contar
+( const char * datos , size_t largo , const char * caracteres )
+{
+	
+	unsigned int n = Simd_Largo_conjunto( caracteres );
+		if( n == 0 || datos == NULL )
+			return 0;
+
+#if SIMD_X86
+	if( Simd_Usar_avx2( ) )
+		return Simd_Contar_avx2( datos , largo , caracteres , n );
+	return Simd_Contar_sse2( datos , largo , caracteres , n );
+#else
+	size_t cantidad = 0;
+	size_t pos;
+	for( pos = 0 ; pos < largo ; pos++ )
+		cantidad += Simd_Pertenece( datos[pos] , caracteres , n );
+	return cantidad;
+#endif
+
+}
+
+/**
+ * @brief Primer caractere de una cadena que pertenece al conjunto, en
+ * una sola pasada (sin strlen previo)
+ *
+ * @return posición del caractere encontrado o del '\0' final
+ */
+const char * Simd_Buscar_en_cadena
+( const char * cadena , const char * caracteres )
+{
+	
+	unsigned int n = Simd_Largo_conjunto( caracteres );
+
+#if SIMD_X86
+	if( Simd_Usar_avx2( ) )
+		return Simd_Buscar_en_cadena_avx2( cadena , caracteres , n );
+	return Simd_Buscar_en_cadena_sse2( cadena , caracteres , n );
+#else
+	while( *cadena != '\0' &&
+		   !Simd_Pertenece( *cadena , caracteres , n ) )
+		cadena++;
+	return cadena;
+#endif
+
+}
+
+/**
+ * @brief Suma los valores de una columna que no son NAN (datos
+ * faltantes)
+ *
+ * @param valores : columna de flotantes
+ * @param largo : cantidad de valores
+ * @param cantidad : para sumarle la cantidad de valores sumados
+ * @return suma en doble precisión
+ */
+double Simd_Sumar
+( const float * valores , size_t largo , size_t * cantidad )
+{
+	
+		if( valores == NULL )
+			return 0;
+
+#if SIMD_X86
+	if( Simd_Usar_avx2( ) )
+		return Simd_Sumar_avx2( valores , largo , cantidad );
+	return Simd_Sumar_sse2( valores , largo , cantidad );
+#else
+	return Simd_Sumar_escalar( valores , largo , cantidad );
+#endif
+
+}
+
+#endif
@@ -0,0 +1,82 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>		/* rand */
+#include <math.h>		/* NAN , fabs */
+
+#include "Simd.h"
+
+int main()
+{
+	
+	char datos[1024];
+	char * separadores = "\r\n,| ";
+	unsigned int n = Simd_Largo_conjunto( separadores );
+	unsigned int errores = 0;
+	
+	printf( "\n AVX2: %s" , Simd_Usar_avx2( ) ? "si" : "no" );
+	
+	unsigned int prueba;
+	for( prueba = 0 ; prueba < 100000 ; prueba++ )
+	{
+		
+		///Datos al azar con pocos separadores y un '\0' final
+		unsigned int largo = rand() % 1000;
+		unsigned int desde = rand() % 16;
+		unsigned int pos;
+		for( pos = 0 ; pos < largo ; pos++ )
+			datos[desde + pos] = ( rand() % 40 == 0 ) ?
+								 separadores[rand() % n] :
+								 'a' + rand() % 26;
+		datos[desde + largo] = '\0';
+		char * cadena = &datos[desde];
+		
+		const char * esperado;
+		esperado = Simd_Buscar_escalar( cadena ,
+										largo ,
+										separadores ,
+										n );
+		if( Simd_Buscar( cadena , largo , separadores ) != esperado )
+			errores++;
+		
+		const char * en_cadena = esperado ? esperado : &cadena[largo];
+		if( Simd_Buscar_en_cadena( cadena , separadores ) != en_cadena )
+			errores++;
+		
+		size_t cantidad = 0;
+		for( pos = 0 ; pos < largo ; pos++ )
+			cantidad += Simd_Pertenece( cadena[pos] , separadores , n );
+		if( Simd_Contar( cadena , largo , separadores ) != cantidad )
+			errores++;
+		
+	}
+	
+	///Sumas con datos faltantes contra la suma escalar
+	float valores[1024];
+	for( prueba = 0 ; prueba < 10000 ; prueba++ )
+	{
+		
+		unsigned int largo = rand() % 1000;
+		unsigned int desde = rand() % 8;
+		unsigned int pos;
+		for( pos = 0 ; pos < largo ; pos++ )
+			valores[desde + pos] = ( rand() % 10 == 0 ) ?
+								   NAN :
+								   ( rand() % 2000 - 1000 ) / 10.0f;
+		
+		size_t esperados = 0;
+		size_t cantidad = 0;
+		double esperado;
+		esperado = Simd_Sumar_escalar( &valores[desde] ,
+									   largo ,
+									   &esperados );
+		double suma = Simd_Sumar( &valores[desde] , largo , &cantidad );
+		if( cantidad != esperados || fabs( suma - esperado ) > 1e-6 )
+			errores++;
+		
+	}
+	
+	printf( "\n errores = %u\n" , errores );
+	
+	return errores != 0;
+	
+}
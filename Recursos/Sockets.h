@@ -18,12 +18,15 @@
 #include <stdlib.h> //atoi
 #include <arpa/inet.h> //inet_aton
 #include <ifaddrs.h> //getifaddrs freeifaddrs
+#include <sys/time.h> //timeval
 
 #include "File.h"
 
 #define TEST_SOCKETS_H 1
 
 #define TAM 256
+///Segundos que se espera la confirmación de cada parte enviada por UDP
+#define SOCKETS_ESPERA_CONFIRMACION 5
 
 struct direccion {
 	
@@ -304,7 +307,7 @@ int Sockets_Crear_Socket_INET_TCP( int * sockfd , int * puerto )
 			return -1;
 		}
 	
-	listen( *sockfd , 0 );
+	listen( *sockfd , SOMAXCONN );
 	
 	Sockets_Si_puerto_es_aleatorio_obtenerlo( *sockfd , puerto );
 	
@@ -416,9 +419,9 @@ struct direccion * dir ;
  * @param sockfd : Socket de comunicacion.
  * @param serv_addr : Datos de la dirección.
  * @param tamanio : Tamaño del mensaje a recibir.
- * @return Mensaje recibido por UDP o 'NULL' en caso de error
+ * @return Bytes recibidos o -1 en caso de error
  */
-void Sockets_Leer_mensaje_UDP
+int Sockets_Leer_mensaje_UDP
 ( sockfd , buffer , tamanio , serv_addr , addr_size )
 int sockfd ;
 char buffer[];
@@ -438,10 +441,10 @@ int addr_size ;
 		if ( error < 0 ) {
 			fprintf( stderr ,
 					"ERROR: No se pudo leer el mensaje. (UDP)" );
-			return;
+			return -1;
 		}
 	
-	return;
+	return error;
 	
 }
 
@@ -582,63 +585,92 @@ int Sockets_Enviar_mensaje_largo_TCP( int sockfdTCP , char * mensaje )
 	return Sockets_Enviar_mensaje_TCP( sockfdTCP , mensaje );
 	
 }
+
+/**
+ * @brief Arma en un solo bloque lo que envía
+ * Sockets_Enviar_mensaje_largo_TCP (el tamanio relleno con '-' hasta
+ * TAM y el mensaje), para enviarlo de a partes sin bloquear
+ *
+ * @param largo : para guardar los bytes a enviar
+ */
+char * Sockets_Mensaje_largo_FREE( char * mensaje , size_t * largo )
+{
+	
+	size_t tam_mensaje = strlen( mensaje );
+	*largo = TAM + tam_mensaje;
+	char * bloque = Mem_assign( *largo + 1 );
+	memset( bloque , '-' , TAM );
+	int digitos = sprintf( bloque , "%u" , (unsigned int)tam_mensaje );
+	bloque[digitos] = '-';
+	memcpy( bloque + TAM , mensaje , tam_mensaje + 1 );
+	
+	return bloque;
+	
+}
  
+/**
+ * @brief Escribe en 'buffer' la parte siguiente de los datos a enviar
+ *
+ * @param maximo : bytes que entran en 'buffer'
+ * @return bytes escritos, menos de 'maximo' solo al terminar
+ */
+typedef unsigned int ( * sockets_fuente )( void * contexto ,
+										   char * buffer ,
+										   unsigned int maximo );
+
 /**
  * @brief A partir de los datos de una conexión UDP preestablecida,
- * envía un archivo por UDP\n
- * Protocolo: Primero envía el tamaño del archivo. En base a eso se 
+ * envía 'tamanio' bytes que entrega la fuente, sin que tengan que
+ * estar en un archivo ni juntos en memoria\n
+ * Protocolo: Primero envía el tamaño de los datos. En base a eso se 
  * calcula la cantidad de partes\n
  * \tPosteriormente envía una parte y recibe una confirmación 
  * (por ser UDP) hasta enviar todas las partes
  * 
- * @param nombre_del_archivo : Ruta del archivo a enviar
+ * @param nombre : Nombre de los datos para mostrar el porcentaje
  * @param mostrar_porcentaje : Varaible de desición la cual al ser 
  * activada imprime el pocentaje de descarga transcurrido por cada 
  * parte por pantalla.
- * @return Si no puede leer el archivo retorna -1 (con error), de lo 
- * contrario 0 (sin error).
+ * @return 0 o -1 si no llega la confirmación de una parte
  */
-int Sockets_Enviar_archivo_por_UDP
-( sockfd , dest_addr , nombre_del_archivo , mostrar_porcentaje )
-int sockfd ;
-struct sockaddr_in dest_addr ;
-char * nombre_del_archivo ;
-int mostrar_porcentaje ;
+int Sockets_Enviar_datos_por_UDP( int sockfd ,
+								  struct sockaddr_in dest_addr ,
+								  long unsigned int tamanio ,
+								  sockets_fuente leer ,
+								  void * contexto ,
+								  char * nombre ,
+								  int mostrar_porcentaje )
 {
 	
-	FILE * archivo = fopen( nombre_del_archivo , "rb" );
-		if ( archivo == NULL ) {
-			fprintf( stderr ,
-					"El fichero solicitado (%s) no existe." ,
-					 nombre_del_archivo );
-			return -1;
-		}
-	
 	int addr_size = sizeof( dest_addr );
-	int tamanio_archivo = File_size(archivo);
+	struct timeval espera = { SOCKETS_ESPERA_CONFIRMACION , 0 };
+	setsockopt( sockfd , SOL_SOCKET , SO_RCVTIMEO , &espera ,
+				sizeof( espera ) );
 	
 	char mensaje[TAM];
 	
 	///Envía el tamaño como primer dato:
 	memset( mensaje , 0 , TAM );
-	snprintf( mensaje , TAM - 1 , "%d" , tamanio_archivo );
-	mensaje[ strlen(mensaje) ] = '\0';
+	snprintf( mensaje , TAM - 1 , "%lu" , tamanio );
 	Sockets_Enviar_mensaje_UDP( sockfd ,
 							   &dest_addr ,
 							    addr_size ,
 							    mensaje );
 	
 	///Se envía una parte y se espera una confirmación,
-	///hasta enviar todas las pertes, menos la última:
-	int ciclo;
-	int partes = ( tamanio_archivo / ( TAM - 1 ) ) + 1;
-				 /* (TAM - 1): Debido a que el último será '\0' */
-	for( ciclo = 1 ; ciclo < partes ; ciclo++ )
+	///hasta enviar todas las partes; la última es más corta:
+	long unsigned int ciclo;
+	long unsigned int partes = ( tamanio / ( TAM - 1 ) ) + 1;
+							   /* (TAM - 1): el último será '\0' */
+	for( ciclo = 1 ; ciclo <= partes ; ciclo++ )
 	{
 		
-		///Lee (TAM - 1) caracteres del archivo:
-		fread( mensaje , 1 , TAM - 1 , archivo );
-		mensaje[ TAM ] = '\0';
+		///Lee hasta (TAM - 1) caracteres de la fuente:
+		unsigned int largo = TAM - 1;
+		if( ciclo == partes )
+			largo = tamanio % ( TAM - 1 );
+		largo = leer( contexto , mensaje , largo );
+		mensaje[largo] = '\0';
 		
 		///Envía una parte:
 		Sockets_Enviar_mensaje_UDP( sockfd ,
@@ -646,39 +678,72 @@ int mostrar_porcentaje ;
 								    addr_size ,
 								    mensaje );
 		
-		///Luego espera confirmación:
-		Sockets_Leer_mensaje_UDP( sockfd ,
-								  TAM ,
-								 &dest_addr ,
-								  addr_size );
+		///Luego espera confirmación; sin ella el cliente no está:
+		if( Sockets_Leer_mensaje_UDP( sockfd ,
+									  mensaje ,
+									  TAM ,
+									 &dest_addr ,
+									  addr_size ) < 0 )
+			return -1;
 		
 		///Imprime el porcentaje:
-		if( mostrar_porcentaje ) 
+		if( mostrar_porcentaje && ciclo < partes )
 			printf( " %s: %3.2f %%\n" ,
-					 nombre_del_archivo ,
+					 nombre ,
 					( (float)ciclo * 100.0 / (float)partes ) ) ;
 		
 	}
+	if( mostrar_porcentaje )
+		printf( " %s: 100 %%\n", nombre ) ;
 	
-	///Envío de la última parte (Posee un tamaño diferente):
-	int tamanio_ultimo_mensaje = tamanio_archivo
-								 - ( ( TAM - 1 ) * ( partes - 1 ) );
-	memset( mensaje , '\0' , TAM );
-	fread( mensaje , 1 , tamanio_ultimo_mensaje , archivo );
-		///Envío:
-		Sockets_Enviar_mensaje_UDP( sockfd ,
-								   &dest_addr ,
-								    addr_size ,
-								    mensaje );
-		///Confirmación:
-		Sockets_Leer_mensaje_UDP(sockfd , TAM , &dest_addr , addr_size);
-		///Imprime el porcentaje.
-		if(mostrar_porcentaje)
-			printf( " %s: 100 %%\n", nombre_del_archivo ) ;
+	return 0;
+	
+}
+
+///Fuente de Sockets_Enviar_datos_por_UDP que lee de un archivo
+unsigned int Sockets_Leer_archivo( void * contexto , char * buffer ,
+								   unsigned int maximo )
+{
+	
+	return fread( buffer , 1 , maximo , (FILE *)contexto );
+	
+}
+
+/**
+ * @brief A partir de los datos de una conexión UDP preestablecida,
+ * envía un archivo por UDP (ver Sockets_Enviar_datos_por_UDP)
+ * 
+ * @param nombre_del_archivo : Ruta del archivo a enviar
+ * @return Si no puede leer el archivo retorna -1 (con error), de lo 
+ * contrario 0 (sin error).
+ */
+int Sockets_Enviar_archivo_por_UDP
+( sockfd , dest_addr , nombre_del_archivo , mostrar_porcentaje )
+int sockfd ;
+struct sockaddr_in dest_addr ;
+char * nombre_del_archivo ;
+int mostrar_porcentaje ;
+{
+	
+	FILE * archivo = fopen( nombre_del_archivo , "rb" );
+		if ( archivo == NULL ) {
+			fprintf( stderr ,
+					"El fichero solicitado (%s) no existe." ,
+					 nombre_del_archivo );
+			return -1;
+		}
+	
+	int error = Sockets_Enviar_datos_por_UDP( sockfd ,
+											  dest_addr ,
+											  File_size( archivo ) ,
+											  Sockets_Leer_archivo ,
+											  archivo ,
+											  nombre_del_archivo ,
+											  mostrar_porcentaje );
 	
 	fclose(archivo);
 	
-	return 0;
+	return error;
 	
 }
 
@@ -729,14 +794,12 @@ int mostrar_porcentaje;
 							 &serv_addr ,
 							  addr_size );
 	
-	char tamanio_str_vect[strlen(tamanio_str)];
-	strcpy( tamanio_str_vect , tamanio_str );
-	int tamanio = atoi(tamanio_str_vect);
-	int partes = ( tamanio / ( TAM - 1 ) ) + 1;
-				 /* TAM - 1: Debido a que el último es '\0' */
+	long unsigned int tamanio = strtoul( tamanio_str , NULL , 10 );
+	long unsigned int partes = ( tamanio / ( TAM - 1 ) ) + 1;
+							   /* TAM - 1: el último es '\0' */
 	
 	///Recepción y escritura del archivo.
-	int ciclo;
+	long unsigned int ciclo;
 	char buffer[TAM];
 	memset( buffer , '\0' , TAM );
 	for( ciclo = 1 ; ciclo <= partes ; ciclo++ )
@@ -11,11 +11,27 @@
 #ifndef STRING_H
 #define STRING_H
 
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "Mem.h"
+#include "Simd.h"
+
+///Lugar para escribir un flotante con String_Flotante_escribir
+#define STRING_LARGO_FLOTANTE 32
+///Dígitos significativos que bastan para cualquier float
+#define STRING_DIGITOS_FLOTANTE 9
+
+///Porción de una cadena o de datos mapeados: no se copia ni termina en
+///'\0', por lo que recorrerla no usa memoria dinámica
+typedef struct {
+	
+	char * inicio;
+	long unsigned int largo;
+	
+} vista;
 
 char * String_Crear( char * cadena )
 {
@@ -26,15 +42,388 @@ char * String_Crear( char * cadena )
 	
 }
 
+/**
+ * @brief Escribe los dígitos decimales de un entero sin signo
+ *
+ * @return cantidad de dígitos escritos (sin '\0')
+ */
+unsigned int String_Escribir_entero( uint64_t numero , char * destino )
+{
+	
+	char digitos[20];
+	unsigned int largo = 0;
+	do
+	{
+		
+		digitos[largo++] = '0' + numero % 10;
+		numero /= 10;
+		
+	} while( numero > 0 );
+	
+	unsigned int pos;
+	for( pos = 0 ; pos < largo ; pos++ )
+		destino[pos] = digitos[largo - 1 - pos];
+	
+	return largo;
+	
+}
+
+/**
+ * @brief Multiplica por 2^bits * 10^ceros si el resultado no supera
+ * 2^100 (ver String_Flotante_mas_corto)
+ *
+ * @return 1 o 0 si se excede
+ */
+int String_Escalar( unsigned __int128 * numero , unsigned int bits ,
+					unsigned int ceros )
+{
+	
+	const unsigned __int128 limite = (unsigned __int128)1 << 100;
+		if( bits >= 100 || *numero > limite >> bits )
+			return 0;
+	*numero <<= bits;
+	while( ceros-- > 0 )
+	{
+		
+			if( *numero > limite / 10 )
+				return 0;
+		*numero *= 10;
+		
+	}
+	
+	return 1;
+	
+}
+
+/**
+ * @brief Quita los ceros a la derecha de D * 10^exponente
+ */
+void String_Normalizar_decimal( uint64_t * digitos , int * exponente )
+{
+	
+	while( *digitos != 0 && *digitos % 10 == 0 )
+	{
+		
+		*digitos /= 10;
+		( *exponente )++;
+		
+	}
+	
+}
+
+/**
+ * @brief Caso rápido de String_Flotante_mas_corto para los valores de
+ * los sensores: con hasta 7 decimales y 2^24 como mantisa tanto el
+ * producto en double como la vuelta a float son exactos, así que se
+ * prueba con cada cantidad de decimales sin enteros de 128 bits
+ *
+ * @return 1 o 0 si el número necesita más cifras
+ */
+int String_Flotante_pocos_decimales( float numero , uint64_t * digitos ,
+									 int * exponente )
+{
+	
+	const double limite = 1 << 24;
+	double potencia = 1;
+	int decimales;
+	for( decimales = 0 ; decimales <= 7 ; decimales++ )
+	{
+		
+		double escalado = (double)numero * potencia;
+			if( escalado >= limite )
+				return 0;
+		
+		uint32_t candidato[2];
+		candidato[0] = escalado;
+		candidato[1] = candidato[0] + 1;
+		
+		///De los dos que vuelven igual, el más cercano (o el par)
+		double abajo = escalado - candidato[0];
+		double arriba = candidato[1] - escalado;
+		int elegido = -1;
+		if( candidato[0] != 0 &&
+			(float)candidato[0] / (float)potencia == numero )
+			elegido = 0;
+		if( (float)candidato[1] / (float)potencia == numero &&
+			( elegido < 0 || arriba < abajo ||
+			  ( arriba == abajo && candidato[1] % 2 == 0 ) ) )
+			elegido = 1;
+		
+		if( elegido >= 0 )
+		{
+			
+			*digitos = candidato[elegido];
+			*exponente = -decimales;
+			String_Normalizar_decimal( digitos , exponente );
+			return 1;
+			
+		}
+		potencia *= 10;
+		
+	}
+	
+	return 0;
+	
+}
+
+/**
+ * @brief Decimal más corto D * 10^exponente que al leerse vuelve a
+ * dar 'numero' (finito y positivo): se prueba con cada vez más dígitos
+ * si el múltiplo de 10^exponente más cercano cae en el intervalo de
+ * valores que redondean a 'numero', comparando con enteros exactos
+ *
+ * @return 1 o 0 si el número es muy grande o muy chico para los
+ * enteros de 128 bits
+ */
+int String_Flotante_mas_corto( float numero , uint64_t * digitos ,
+							   int * exponente )
+{
+	
+	if( String_Flotante_pocos_decimales( numero ,
+										 digitos ,
+										 exponente ) )
+		return 1;
+	
+	uint32_t bits;
+	memcpy( &bits , &numero , 4 );
+	uint32_t fraccion = bits & 0x7FFFFF;
+	int exponente_binario = ( bits >> 23 ) & 0xFF;
+	
+	///numero = m * 2^e; el intervalo, en unidades de 2^(e - 2)
+	uint64_t m = fraccion;
+	int e = exponente_binario - 152;
+	if( exponente_binario == 0 )
+		e = 1 - 152;
+	else
+		m |= 0x800000;
+	uint64_t valor = 4 * m;
+	uint64_t alto = valor + 2;
+	uint64_t bajo = fraccion == 0 && exponente_binario > 1 ?
+					valor - 1 :
+					valor - 2;
+	int incluye_bordes = m % 2 == 0;
+	
+	///Estimo la potencia de 10 del número (log10(2) ~ 77 / 256)
+	int bits_m = 64 - __builtin_clzll( m );
+	int potencia = ( ( e + bits_m ) * 77 ) >> 8;
+	
+	int k;
+	for( k = potencia + 1 ;
+		 k >= potencia - STRING_DIGITOS_FLOTANTE - 2 ;
+		 k-- )
+	{
+		
+		///valor * 2^e / 10^k = a / divisor
+		unsigned __int128 escala = 1;
+		unsigned __int128 divisor = 1;
+		if( !String_Escalar( &escala , e > 0 ? e : 0 ,
+							 k < 0 ? -k : 0 ) ||
+			!String_Escalar( &divisor , e < 0 ? -e : 0 ,
+							 k > 0 ? k : 0 ) )
+			return 0;
+		unsigned __int128 a = valor * escala;
+		unsigned __int128 a_bajo = bajo * escala;
+		unsigned __int128 a_alto = alto * escala;
+		
+		uint64_t candidato[2];
+		candidato[0] = a / divisor;
+		candidato[1] = candidato[0] + ( a % divisor != 0 );
+		int elegido = -1;
+		int pos;
+		for( pos = 0 ; pos < 2 ; pos++ )
+		{
+			
+			unsigned __int128 d = candidato[pos];
+			if( d == 0 || __builtin_mul_overflow( d , divisor , &d ) )
+				continue;
+			int adentro = incluye_bordes ?
+						  d >= a_bajo && d <= a_alto :
+						  d > a_bajo && d < a_alto;
+			if( !adentro )
+				continue;
+			
+			///Si los dos sirven, el más cercano (o el par)
+			if( elegido == 0 )
+			{
+				
+				unsigned __int128 abajo = a - candidato[0] * divisor;
+				unsigned __int128 arriba = d - a;
+				if( arriba < abajo ||
+					( arriba == abajo && candidato[1] % 2 == 0 ) )
+					elegido = 1;
+				
+			}
+			else
+				elegido = pos;
+			
+		}
+		
+		if( elegido >= 0 )
+		{
+			
+			*digitos = candidato[elegido];
+			*exponente = k;
+			String_Normalizar_decimal( digitos , exponente );
+			return 1;
+			
+		}
+		
+	}
+	
+	return 0;
+	
+}
+
+/**
+ * @brief Igual a String_Flotante_mas_corto, para los números fuera de
+ * su rango: prueba con cada cantidad de dígitos hasta que vuelva igual
+ */
+void String_Flotante_mas_corto_printf( float numero ,
+									   uint64_t * digitos ,
+									   int * exponente )
+{
+	
+	char texto[STRING_LARGO_FLOTANTE];
+	int precision;
+	for( precision = 0 ;
+		 precision < STRING_DIGITOS_FLOTANTE ;
+		 precision++ )
+	{
+		
+		snprintf( texto , sizeof( texto ) , "%.*e" , precision ,
+				  numero );
+		if( strtof( texto , NULL ) == numero )
+			break;
+		
+	}
+	
+	///texto = "d.ddde[+-]xx"
+	*digitos = 0;
+	*exponente = 0;
+	char * c;
+	for( c = texto ; *c != 'e' ; c++ )
+		if( *c != '.' )
+		{
+			
+			*digitos = *digitos * 10 + ( *c - '0' );
+			( *exponente )--;
+			
+		}
+	*exponente += atoi( c + 1 ) + 1;
+	String_Normalizar_decimal( digitos , exponente );
+	
+}
+
+/**
+ * @brief Escribe un flotante con la menor cantidad de dígitos que al
+ * leerse vuelve a dar el mismo número ("23.5", "0.001", "1.5e+25"),
+ * sin memoria dinámica
+ *
+ * @param destino : al menos STRING_LARGO_FLOTANTE bytes
+ * @return cantidad de caracteres escritos (sin el '\0')
+ */
+unsigned int String_Flotante_escribir( float numero , char * destino )
+{
+	
+	char * c = destino;
+	if( __builtin_isnan( numero ) )
+	{
+		
+		strcpy( destino , "nan" );
+		return 3;
+		
+	}
+	if( __builtin_signbit( numero ) )
+	{
+		
+		*c++ = '-';
+		numero = -numero;
+		
+	}
+	if( __builtin_isinf( numero ) || numero == 0 )
+	{
+		
+		strcpy( c , numero == 0 ? "0" : "inf" );
+		return c - destino + strlen( c );
+		
+	}
+	
+	uint64_t digitos;
+	int exponente;
+	if( !String_Flotante_mas_corto( numero , &digitos , &exponente ) )
+		String_Flotante_mas_corto_printf( numero ,
+										  &digitos ,
+										  &exponente );
+	char cifras[20];
+	int largo = String_Escribir_entero( digitos , cifras );
+	
+	///Posición de la coma respecto de la primer cifra
+	int coma = largo + exponente;
+	if( coma > 21 || coma < -5 )
+	{
+		
+		*c++ = cifras[0];
+		if( largo > 1 )
+		{
+			
+			*c++ = '.';
+			memcpy( c , &cifras[1] , largo - 1 );
+			c += largo - 1;
+			
+		}
+		*c++ = 'e';
+		*c++ = coma - 1 < 0 ? '-' : '+';
+		int potencia = coma - 1 < 0 ? 1 - coma : coma - 1;
+		if( potencia < 10 )
+			*c++ = '0';
+		c += String_Escribir_entero( potencia , c );
+		
+	}
+	else if( exponente >= 0 )
+	{
+		
+		memcpy( c , cifras , largo );
+		c += largo;
+		memset( c , '0' , exponente );
+		c += exponente;
+		
+	}
+	else if( coma > 0 )
+	{
+		
+		memcpy( c , cifras , coma );
+		c += coma;
+		*c++ = '.';
+		memcpy( c , &cifras[coma] , largo - coma );
+		c += largo - coma;
+		
+	}
+	else
+	{
+		
+		*c++ = '0';
+		*c++ = '.';
+		memset( c , '0' , -coma );
+		c += -coma;
+		memcpy( c , cifras , largo );
+		c += largo;
+		
+	}
+	*c = '\0';
+	
+	return c - destino;
+	
+}
+
 char * String_Flotante_a_cadena_FREE( float numero )
 {
 	
-	char numero_str[50];
-	memset( numero_str , '\0' , 50 );
-	sprintf( numero_str , "%f" , numero );
+	char numero_str[STRING_LARGO_FLOTANTE];
+	unsigned int largo;
+	largo = String_Flotante_escribir( numero , numero_str );
 	
-	char * retorno = (char *)Mem_assign( strlen( numero_str ) );
-	strcpy( retorno , numero_str );
+	char * retorno = Mem_Create_string( largo );
+	memcpy( retorno , numero_str , largo + 1 );
 	
 	return retorno;
 	
@@ -80,37 +469,19 @@ String_Cantidad_de_columnas( char * cadena , char * separadores )
 	if( cadena == NULL || separadores == NULL )
 		return 0;
 	
-	unsigned int cantidad = 0;
+	unsigned int largo = strlen( cadena );
+		if( largo == 0 )
+			return 0;
 	
-	unsigned int nro_sep = strlen( separadores );
-	char * puntero;
-	unsigned int separador_nro;
-	
-	for( puntero = &cadena[0] ; puntero[0] != '\0' ; puntero++ )
-	{
-		
-		for( separador_nro = 0 ; \
-			 separador_nro < nro_sep ; \
-			 separador_nro++ )
-		{
-			
-			if( puntero[0] == separadores[separador_nro] )
-				cantidad++;
-			
-		}
-		
-	}
+	unsigned int cantidad = Simd_Contar( cadena , largo , separadores );
 	
 	///Si empieza con un separador, resto uno
-	for( separador_nro = 0 ; separador_nro < nro_sep ; separador_nro++ )
-		if( cadena[0] == separadores[separador_nro] )
-			cantidad--;
+	if( Simd_Buscar( cadena , 1 , separadores ) != NULL )
+		cantidad--;
 	
-	///Si termina no termina con un separador, cuento una columna mas
-	puntero--;
-	for( separador_nro = 0 ; separador_nro < nro_sep ; separador_nro++ )
-		if( puntero[0] != separadores[separador_nro] )
-			return cantidad + 1;
+	///Si no termina con un separador, cuento una columna mas
+	if( Simd_Buscar( &cadena[largo - 1] , 1 , separadores ) == NULL )
+		cantidad++;
 	
 	return cantidad;
 	
@@ -121,7 +492,7 @@ String_Cantidad_de_columnas( char * cadena , char * separadores )
  * dentro de un conjunto
  * 
  * @param cadena : a buscar
- * @param caracteres : conjunto que buscar
+ * @param caracteres : conjunto que buscar (hasta SIMD_MAX_CARACTERES)
  * @return posicion de la primer ocurrencia o -1 si no encuentra
  */
 int String_Posicion_siguiente_char( char * cadena , char * caracteres )
@@ -129,19 +500,13 @@ int String_Posicion_siguiente_char( char * cadena , char * caracteres )
 	
 	if( cadena == NULL )
 		return -1;
-
-	int tam_cadena = strlen( cadena );
-	int cant_car = strlen( caracteres );
-	int pos_cadena;
-	int caractere_nro;
-	for( pos_cadena = 0 ; pos_cadena < tam_cadena ; pos_cadena++ )
-		for( caractere_nro = 0 ; \
-			 caractere_nro < cant_car ; \
-			 caractere_nro++ )
-			if( cadena[pos_cadena] == caracteres[caractere_nro] )
-				return pos_cadena;
 	
-	return -1;
+	const char * encontrado;
+	encontrado = Simd_Buscar_en_cadena( cadena , caracteres );
+		if( *encontrado == '\0' )
+			return -1;
+	
+	return encontrado - cadena;
 	
 }
 
@@ -183,25 +548,21 @@ char * String_copiar_n_FREE( char * cadena ,  int n )
 char * String_Cortar_hasta_FREE( char ** cadena , char * caracteres )
 {
 	
-	if( cadena == NULL )
+	if( cadena == NULL || *cadena == NULL )
 		return NULL;
-
-	int pos;
-	pos = String_Posicion_siguiente_char( *cadena , caracteres );
 	
-		if( pos == -1 )
-		{
-			
-			char * copia;
-			copia = (char *)Mem_Create_string( strlen(*cadena) );
-			strcpy( copia , *cadena );
-			*cadena = NULL;
-			return copia;
-			
-		}
+	///Una pasada encuentra el caracter o el fin de la cadena
+	const char * fin = Simd_Buscar_en_cadena( *cadena , caracteres );
+	unsigned int largo = fin - *cadena;
+	
+	char * copia = Mem_Create_string( largo );
+	memcpy( copia , *cadena , largo );
+	
+	if( *fin == '\0' )
+		*cadena = NULL;
+	else
+		*cadena = (char *)fin + 1;
 	
-	char * copia = String_copiar_n_FREE( *cadena , pos );
-	*cadena = *cadena + pos + 1;
 	return copia;
 	
 }
@@ -218,16 +579,420 @@ void String_Mover_hasta
 ( char ** cadena , char * caracteres , unsigned int add )
 {
 	
-	if( cadena == NULL )
+	if( cadena == NULL || *cadena == NULL )
 		return;
 	
-	int pos;
-	pos = String_Posicion_siguiente_char( *cadena , caracteres );
-	
-		if( pos == -1 )
+	const char * encontrado;
+	encontrado = Simd_Buscar_en_cadena( *cadena , caracteres );
+		if( *encontrado == '\0' )
 			return;
 	
-	*cadena = *cadena + pos + add;
+	*cadena = (char *)encontrado + add;
+	
+}
+
+vista String_Vista( char * inicio , long unsigned int largo )
+{
+	
+	vista v;
+	v.inicio = inicio;
+	v.largo = largo;
+	
+	return v;
+	
+}
+
+vista String_Vista_de_cadena( char * cadena )
+{
+	
+	if( cadena == NULL )
+		return String_Vista( NULL , 0 );
+	
+	return String_Vista( cadena , strlen( cadena ) );
+	
+}
+
+/**
+ * @brief Corta el siguiente campo de una vista sin copiarlo, y la
+ * avanza al campo posterior; como String_Cortar_hasta_FREE, al cortar
+ * el último campo el inicio de la vista pasa a ser NULL
+ *
+ * @param resto : vista a recorrer (se modifica)
+ * @param caracteres : conjunto de separadores
+ * @param campo : para guardar el campo cortado
+ * @return 1 si cortó un campo, 0 si la vista ya fue recorrida
+ */
+int String_Siguiente_campo
+( vista * resto , char * caracteres , vista * campo )
+{
+	
+	if( resto->inicio == NULL )
+		return 0;
+	
+	const char * separador;
+	separador = Simd_Buscar( resto->inicio ,
+							 resto->largo ,
+							 caracteres );
+	
+	campo->inicio = resto->inicio;
+	if( separador == NULL )
+	{
+		
+		campo->largo = resto->largo;
+		resto->inicio = NULL;
+		resto->largo = 0;
+		return 1;
+		
+	}
+	
+	campo->largo = separador - resto->inicio;
+	resto->inicio = (char *)separador + 1;
+	resto->largo -= campo->largo + 1;
+	
+	return 1;
+	
+}
+
+/**
+ * @brief Saltea una cantidad de campos de la vista
+ *
+ * @return cantidad de campos salteados
+ */
+unsigned int String_Saltear_campos
+( vista * resto , char * caracteres , unsigned int cantidad )
+{
+	
+	vista campo;
+	unsigned int salteados = 0;
+	while( salteados < cantidad &&
+		   String_Siguiente_campo( resto , caracteres , &campo ) )
+		salteados++;
+	
+	return salteados;
+	
+}
+
+/**
+ * @return 1 si las vistas tienen el mismo contenido, 0 si no
+ */
+int String_Vista_igual( vista a , vista b )
+{
+	
+	if( a.largo != b.largo )
+		return 0;
+	
+	return a.largo == 0 || memcmp( a.inicio , b.inicio , a.largo ) == 0;
+	
+}
+
+/**
+ * @return 1 si la vista tiene el contenido de la cadena, 0 si no
+ */
+int String_Vista_igual_cadena( vista v , char * cadena )
+{
+	
+	return String_Vista_igual( v , String_Vista_de_cadena( cadena ) );
+	
+}
+
+/**
+ * @return 1 si la vista comienza con el contenido de la cadena, 0 si no
+ */
+int String_Vista_empieza_con( vista v , char * cadena )
+{
+	
+	long unsigned int largo = strlen( cadena );
+	
+	return v.largo >= largo && memcmp( v.inicio , cadena , largo ) == 0;
+	
+}
+
+/**
+ * @brief Convierte la vista en un número entero (con signo opcional)
+ *
+ * @param valor : para guardar el número
+ * @return 1 si toda la vista es un número, 0 si no
+ */
+int String_Vista_a_entero( vista v , long int * valor )
+{
+	
+	long unsigned int pos = 0;
+	int signo = 1;
+	if( v.largo > 0 && ( v.inicio[0] == '-' || v.inicio[0] == '+' ) )
+	{
+		
+		signo = v.inicio[0] == '-' ? -1 : 1;
+		pos++;
+		
+	}
+		if( pos == v.largo )
+			return 0;
+	
+	long int numero = 0;
+	for( ; pos < v.largo ; pos++ )
+	{
+		
+		if( v.inicio[pos] < '0' || v.inicio[pos] > '9' )
+			return 0;
+		numero = numero * 10 + ( v.inicio[pos] - '0' );
+		
+	}
+	
+	*valor = signo * numero;
+	
+	return 1;
+	
+}
+
+/**
+ * @brief Convierte la vista en un número de punto flotante. Los
+ * decimales comunes ("-12.5") se leen directamente: con hasta 7 cifras
+ * significativas y 10 decimales el resultado es exacto con una sola
+ * operación; el resto (exponentes, "inf", espacios) lo lee strtof
+ *
+ * @param valor : para guardar el número
+ * @return 1 si la vista comienza con un número, 0 si no
+ */
+int String_Vista_a_flotante( vista v , float * valor )
+{
+	
+	static const float potencias[] = { 1e0f , 1e1f , 1e2f , 1e3f ,
+										1e4f , 1e5f , 1e6f , 1e7f ,
+										1e8f , 1e9f , 1e10f };
+	
+	if( v.largo == 0 )
+		return 0;
+	
+	const char * c = v.inicio;
+	const char * final = v.inicio + v.largo;
+	int negativo = *c == '-';
+	if( *c == '-' || *c == '+' )
+		c++;
+	
+	uint32_t mantisa = 0;
+	int exponente = 0;
+	int cifras = 0;
+	int rapido = 1;
+	int punto = 0;
+	for( ; c < final ; c++ )
+	{
+		
+		unsigned int digito = (unsigned char)*c - '0';
+		if( digito > 9 )
+		{
+			
+			if( *c != '.' || punto )
+				break;
+			punto = 1;
+			continue;
+			
+		}
+		cifras++;
+		if( mantisa > ( ( 1 << 24 ) - digito ) / 10 )
+			rapido = 0;
+		else
+		{
+			
+			mantisa = mantisa * 10 + digito;
+			exponente -= punto;
+			
+		}
+		
+	}
+	if( c < final && ( *c == 'e' || *c == 'E' ) )
+		rapido = 0;
+	
+	if( rapido && cifras > 0 && exponente >= -10 )
+	{
+		
+		float numero = (float)mantisa / potencias[-exponente];
+		*valor = negativo ? -numero : numero;
+		return 1;
+		
+	}
+	
+	///strtof necesita un fin de cadena: copio a la pila
+	char numero[32];
+	long unsigned int largo = v.largo;
+	if( largo >= sizeof( numero ) )
+		largo = sizeof( numero ) - 1;
+	memcpy( numero , v.inicio , largo );
+	numero[largo] = '\0';
+	
+	char * fin;
+	*valor = strtof( numero , &fin );
+	
+	return fin != numero;
+	
+}
+
+/**
+ * @brief Copia el contenido de la vista en una cadena nueva
+ */
+char * String_Vista_copiar_FREE( vista v )
+{
+	
+	char * copia = Mem_Create_string( v.largo );
+	if( v.largo > 0 )
+		memcpy( copia , v.inicio , v.largo );
+	
+	return copia;
+	
+}
+
+/**
+ * @brief Copia el contenido de la vista en una cadena del área
+ */
+char * String_Vista_copiar_en( arena * area , vista v )
+{
+	
+	char * copia = Mem_Arena_create_string( area , v.largo );
+	if( v.largo > 0 )
+		memcpy( copia , v.inicio , v.largo );
+	
+	return copia;
+	
+}
+
+/**
+ * Cadena que crece al agregarle partes: guarda su largo, así que
+ * agregar no recorre lo ya escrito como strcat, y duplica lo asignado
+ * al llenarse. Siempre termina en '\0'
+ */
+typedef struct {
+	
+	char * texto;
+	long unsigned int largo;
+	size_t asignados;
+	arena * area; /// de donde se asigna o NULL para malloc
+	
+} cadena_creciente;
+
+/**
+ * @param capacidad : largo estimado (crece si no alcanza)
+ */
+void String_Creciente_Iniciar( cadena_creciente * c ,
+							 long unsigned int capacidad )
+{
+	
+	c->asignados = capacidad + 1;
+	c->texto = Mem_assign( c->asignados );
+	c->texto[0] = '\0';
+	c->largo = 0;
+	c->area = NULL;
+	
+}
+
+/**
+ * @brief Cadena asignada en un área: se libera con ella (no con
+ * String_Creciente_FREE) y el texto se toma de c->texto
+ */
+void String_Creciente_Iniciar_en( cadena_creciente * c ,
+								long unsigned int capacidad ,
+								arena * area )
+{
+	
+	c->asignados = capacidad + 1;
+	c->texto = Mem_Arena_assign( area , c->asignados );
+	c->texto[0] = '\0';
+	c->largo = 0;
+	c->area = area;
+	
+}
+
+/**
+ * @brief Lugar para escribir hasta 'n' caracteres (y el '\0') al final;
+ * quien escribe suma lo escrito a c->largo y lo termina en '\0'
+ *
+ * @return fin de la cadena
+ */
+char * String_Creciente_Lugar( cadena_creciente * c ,
+							  long unsigned int n )
+{
+	
+	size_t necesarios = c->largo + n + 1;
+	if( c->area == NULL )
+		c->texto = Mem_grow( c->texto , &c->asignados , necesarios );
+	else if( necesarios > c->asignados )
+	{
+		
+		size_t asignados = c->asignados * 2 + 64;
+		if( asignados < necesarios )
+			asignados = necesarios;
+		c->texto = Mem_Arena_reassign( c->area , c->texto ,
+									   c->largo + 1 , asignados );
+		c->asignados = asignados;
+		
+	}
+	
+	return &c->texto[c->largo];
+	
+}
+
+void String_Agregar_n( cadena_creciente * c , const char * parte ,
+					   long unsigned int n )
+{
+	
+	char * fin = String_Creciente_Lugar( c , n );
+	memcpy( fin , parte , n );
+	c->largo += n;
+	c->texto[c->largo] = '\0';
+	
+}
+
+void String_Agregar( cadena_creciente * c , const char * parte )
+{
+	
+	String_Agregar_n( c , parte , strlen( parte ) );
+	
+}
+
+void String_Agregar_vista( cadena_creciente * c , vista v )
+{
+	
+	String_Agregar_n( c , v.inicio , v.largo );
+	
+}
+
+void String_Agregar_caracter( cadena_creciente * c , char caracter )
+{
+	
+	char * fin = String_Creciente_Lugar( c , 1 );
+	fin[0] = caracter;
+	fin[1] = '\0';
+	c->largo++;
+	
+}
+
+void String_Agregar_entero( cadena_creciente * c , uint64_t numero )
+{
+	
+	char * fin = String_Creciente_Lugar( c , 20 );
+	c->largo += String_Escribir_entero( numero , fin );
+	c->texto[c->largo] = '\0';
+	
+}
+
+void String_Agregar_flotante( cadena_creciente * c , float numero )
+{
+	
+	char * fin = String_Creciente_Lugar( c , STRING_LARGO_FLOTANTE );
+	c->largo += String_Flotante_escribir( numero , fin );
+	
+}
+
+/**
+ * @brief Entrega el texto armado (la cadena queda vacía)
+ */
+char * String_Creciente_FREE( cadena_creciente * c )
+{
+	
+	char * texto = c->texto;
+	c->texto = NULL;
+	c->largo = 0;
+	c->asignados = 0;
+	
+	return texto;
 	
 }
 
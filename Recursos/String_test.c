@@ -1,6 +1,6 @@
 #include <stdio.h>
 #include <string.h>
-#include <stdlib.h>		/* malloc */
+#include <stdlib.h>		/* malloc , rand , strtof */
 
 #include "String.h"
 
@@ -12,12 +12,187 @@ int main()
 	do
 	{
 		
-		printf( "\n %s" , String_Cortar_hasta( &cadena , ",\n" ) );
+		char * campo = String_Cortar_hasta_FREE( &cadena , ",\n" );
+		printf( "\n %s" , campo );
+		free( campo );
 		
 	} while( cadena != NULL );
 	
+	///Flotantes: ida y vuelta con el menor largo posible
+	unsigned int errores = 0;
+	char texto[STRING_LARGO_FLOTANTE];
+	char referencia[STRING_LARGO_FLOTANTE];
+	unsigned int prueba;
+	for( prueba = 0 ; prueba < 1000000 ; prueba++ )
+	{
+		
+		float numero;
+		if( prueba % 2 == 0 )
+			numero = ( rand() % 200000 - 100000 ) / 10.0f;
+		else
+		{
+			
+			uint32_t bits = ( (uint32_t)rand() << 1 ) ^ rand();
+			memcpy( &numero , &bits , 4 );
+			if( numero != numero )
+				continue;
+			
+		}
+		
+		unsigned int largo = String_Flotante_escribir( numero , texto );
+		float leido;
+		if( largo != strlen( texto ) ||
+			strtof( texto , NULL ) != numero ||
+			!String_Vista_a_flotante( String_Vista( texto , largo ) ,
+									  &leido ) ||
+			leido != numero )
+		{
+			
+			printf( "\n Error: %.9g escrito como \"%s\"" ,
+					numero ,
+					texto );
+			errores++;
+			continue;
+			
+		}
+		
+		///Ninguna precisión de printf da menos cifras
+		int precision;
+		for( precision = 1 ; precision < 9 ; precision++ )
+		{
+			
+			snprintf( referencia , sizeof( referencia ) , "%.*g" ,
+					  precision , numero );
+			if( strtof( referencia , NULL ) == numero )
+				break;
+			
+		}
+		///Cifras significativas: de la primera a la última no nula
+		int primera = -1;
+		int cifras = 0;
+		int digito = 0;
+		char * c;
+		for( c = texto ; *c != '\0' && *c != 'e' ; c++ )
+		{
+			
+			if( *c < '0' || *c > '9' )
+				continue;
+			if( *c != '0' && primera < 0 )
+				primera = digito;
+			if( *c != '0' )
+				cifras = digito - primera + 1;
+			digito++;
+			
+		}
+		if( cifras > precision )
+		{
+			
+			printf( "\n Error: \"%s\" es más largo que \"%s\"" ,
+					texto ,
+					referencia );
+			errores++;
+			
+		}
+		
+	}
+	
+	char * textos[] = { "23.5" , "-0.0" , "12abc" , "1e3" , " 7" ,
+						"--" , ".5" , "0.00001234" , "123456789" , "" };
+	unsigned int cantidad = sizeof( textos ) / sizeof( char * );
+	unsigned int pos;
+	for( pos = 0 ; pos < cantidad ; pos++ )
+	{
+		
+		char * fin;
+		float esperado = strtof( textos[pos] , &fin );
+		float leido = 0;
+		vista v = String_Vista_de_cadena( textos[pos] );
+		int leyo = String_Vista_a_flotante( v , &leido );
+		if( leyo != ( fin != textos[pos] ) ||
+			( leyo && leido != esperado ) )
+		{
+			
+			printf( "\n Error al leer \"%s\"" , textos[pos] );
+			errores++;
+			
+		}
+		
+	}
+	
+	///Cadena que crece contra la misma armada con snprintf
+	cadena_creciente c;
+	String_Creciente_Iniciar( &c , 0 );
+	char * esperado = Mem_Create_string( 1 << 20 );
+	long unsigned int largo = 0;
+	for( prueba = 0 ; largo < ( 1 << 20 ) - 64 ; prueba++ )
+	{
+		
+		switch( prueba % 4 )
+		{
+			
+			case 0:
+				String_Agregar( &c , "\tEstación " );
+				largo += sprintf( &esperado[largo] , "\tEstación " );
+				break;
+			
+			case 1:
+				String_Agregar_entero( &c , prueba * 7919ULL );
+				largo += sprintf( &esperado[largo] , "%llu" ,
+								  prueba * 7919ULL );
+				break;
+			
+			case 2:
+				String_Agregar_caracter( &c , ':' );
+				esperado[largo++] = ':';
+				break;
+			
+			default:
+				String_Agregar_flotante( &c , prueba / 4.0f );
+				largo += String_Flotante_escribir( prueba / 4.0f ,
+												   &esperado[largo] );
+				break;
+			
+		}
+		
+	}
+	esperado[largo] = '\0';
+	if( c.largo != largo || strlen( c.texto ) != largo ||
+		strcmp( c.texto , esperado ) != 0 )
+	{
+		
+		printf( "\n Error en la cadena armada" );
+		errores++;
+		
+	}
+	char * armado = String_Creciente_FREE( &c );
+	
+	///La misma en un área, con partes de otro largo intercaladas
+	arena * area = Mem_Arena_create( 4096 );
+	String_Creciente_Iniciar_en( &c , 0 , area );
+	long unsigned int copiado;
+	for( copiado = 0 ; copiado < largo ; copiado += 1000 )
+	{
+		
+		unsigned int parte = largo - copiado < 1000 ? largo - copiado :
+													  1000;
+		String_Agregar_n( &c , &armado[copiado] , parte );
+		if( copiado % 3000 == 0 )
+			Mem_Arena_assign( area , copiado % 7000 );
+		
+	}
+	if( c.largo != largo || strcmp( c.texto , esperado ) != 0 )
+	{
+		
+		printf( "\n Error en la cadena armada en un área" );
+		errores++;
+		
+	}
+	Mem_Arena_delete( &area );
+	Mem_desassign( (void **)&armado );
+	Mem_desassign( (void **)&esperado );
 	
+	printf( "\n errores = %u\n" , errores );
 	
-	printf( "\n" );
+	return errores != 0;
 	
 }
@@ -0,0 +1,2014 @@
+/**
+ * @author Fernández Nicolás (nicofernandez@alumnos.unc.edu.ar)
+ * @date Mayo, 2017
+ * @version 0.5.2017 beta
+ *
+ * @brief Base de datos meteorológica residente en memoria: el archivo
+ * se mapea y recorre una única vez al iniciar el servidor y se separa
+ * en columnas (una por variable, comprimidas por bloques) para
+ * responder los comandos sin volver a leerlo
+ *
+ * \file BD.h
+ */
+
+#ifndef BD_H
+#define BD_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h> //NAN , isnan
+#include <stdint.h> //INT64_MIN
+#include <strings.h> //strcasecmp
+
+#include "../Recursos/Compresion.h"
+#include "../Recursos/Cuantiles.h"
+#include "../Recursos/Fecha.h"
+#include "../Recursos/File.h"
+#include "../Recursos/Hilos.h"
+#include "../Recursos/Mem.h"
+#include "../Recursos/String.h"
+
+#define BD_ARCHIVO "datos_meteorologicos.CSV"
+#define BD_FIN_DE_FILA 13
+///Filas previas a los datos (la 3ra es la cabecera)
+#define BD_FILAS_DE_CABECERA 3
+///Columnas previas a las variables: número, nombre, localidad y fecha
+#define BD_COLUMNA_FECHA 3
+#define BD_PRIMER_VARIABLE 4
+///Columna de la variable precipitación, acumulada por día y por mes
+#define BD_COLUMNA_PRECIPITACION 7
+///Direcciones reservadas para que el archivo crezca sin remapearlo
+#define BD_RESERVA ( 1UL << 36 )
+///Mínimo de filas que justifica sumar una columna en otro hilo
+#define BD_FILAS_POR_HILO 65536
+///Mínimo de bytes del archivo que justifica leerlos en otro hilo
+#define BD_BYTES_POR_HILO ( 1UL << 20 )
+///Marca de tiempo de una fila sin fecha válida
+#define BD_SIN_FECHA INT64_MIN
+
+///Filas consecutivas de una misma estación en el archivo
+typedef struct {
+	
+	long unsigned int inicio; /// desplazamiento en los datos
+	long unsigned int largo; /// bytes, incluidos los fines de fila
+	long unsigned int primera_fila;
+	long unsigned int filas;
+	
+} tramo;
+
+///Precipitación acumulada de un día o un mes
+typedef struct {
+	
+	long int clave; /// Fecha_Dia o Fecha_Mes
+	float acumulado;
+	
+} acumulado;
+
+/**
+ * Filas consecutivas de una estación dentro de un mismo bloque de las
+ * columnas, con el rango de sus marcas de tiempo: índice para buscar
+ * por fecha descomprimiendo solo los bloques que pueden coincidir
+ */
+typedef struct {
+	
+	long unsigned int primera_fila;
+	unsigned int filas;
+	int64_t desde; /// nunca mayor que la primer marca válida
+	int64_t hasta; /// máximo de las marcas válidas
+	
+} segmento;
+
+typedef struct {
+	
+	acumulado * a;
+	unsigned int cant;
+	unsigned int asignados;
+	
+} acumulados;
+
+typedef struct {
+	
+	char * numero;
+	char * nombre;
+	long unsigned int filas;
+	unsigned int campos; /// variables con datos en su primer fila
+	tramo * tramos;
+	unsigned int cant_tramos;
+	unsigned int tramos_asignados;
+	acumulados dias; /// precipitación, en el orden del archivo
+	acumulados meses;
+	segmento * segmentos;
+	unsigned int cant_segmentos;
+	unsigned int segmentos_asignados;
+	int64_t ultimo_tiempo; /// última marca válida
+	int ordenado; /// 1 si las marcas válidas nunca retroceden
+	cuantiles * distribuciones; /// una por variable, para percentiles
+	
+} estacion;
+
+///Tramo de una estación, en el orden de las filas del archivo
+typedef struct {
+	
+	long unsigned int estacion;
+	unsigned int tramo;
+	
+} orden_tramo;
+
+/**
+ * Columna de una variable: bloques comprimidos de COMPRESION_BLOQUE
+ * filas y, sin comprimir, las filas del último bloque incompleto
+ */
+typedef struct {
+	
+	bloque_flotantes * bloques;
+	long unsigned int cant_bloques;
+	long unsigned int bloques_asignados;
+	float * cola; /// filas desde cant_bloques * COMPRESION_BLOQUE
+	
+} columna;
+
+///Marcas de tiempo de las filas, comprimidas como las columnas
+typedef struct {
+	
+	bloque_enteros * bloques;
+	long unsigned int cant_bloques;
+	long unsigned int bloques_asignados;
+	int64_t * cola;
+	
+} columna_tiempos;
+
+typedef struct {
+	
+	file_map * archivo;
+	char * datos; /// contenido completo del archivo (mapeado)
+	long unsigned int tam;
+	long unsigned int inicio_datos; /// desplazamiento de la 4ta fila
+	long unsigned int procesado; /// fin de la última fila completa
+	long unsigned int ultima_fila; /// inicio de la que termina ahí
+	uint64_t firma_cabecera; /// de los bytes previos a los datos
+	uint64_t firma_ultima_fila;
+	int vigilancia; /// inotify del archivo o -1 si no se sigue
+	char * ruta; /// del archivo seguido
+	long unsigned int version; /// aumenta con cada fila agregada
+	text * cabecera;
+	unsigned int variables;
+	estacion * estaciones;
+	long unsigned int cant_estaciones;
+	long unsigned int estaciones_asignadas;
+	long unsigned int ultima_estacion; /// de la última fila cargada
+	long unsigned int filas;
+	columna_tiempos tiempos; /// segundos desde 1970 o BD_SIN_FECHA
+	columna * columnas; /// una por variable, NAN para "--"
+	orden_tramo * orden; /// tramos de todas las estaciones
+	long unsigned int cant_orden;
+	long unsigned int orden_asignados;
+	
+} bd;
+
+unsigned int Cantidad_de_simbolos( char * cadena )
+{
+	
+	unsigned int cantidad = 0;
+	
+	int pos;
+	for( pos = 0 ; pos < strlen( cadena ) ; pos++ )
+	{
+		
+		if( cadena[pos] < 0 )
+			cantidad++;
+		
+	}
+	
+	return cantidad;
+	
+}
+
+char * Corregir_simbolos_FREE( char * cadena )
+{
+	
+	int correcciones = Cantidad_de_simbolos( cadena );
+	
+	char * cadena_corregida;
+	cadena_corregida = Mem_Create_string_set( strlen( cadena )
+											  + correcciones ,
+											  '\0' );
+	
+	correcciones = 0;
+	
+	int pos;
+	for( pos = 0 ; pos < strlen(cadena) ; pos++ )
+	{
+		
+		if( cadena[pos] < 0 )
+			correcciones++;
+		
+		switch( cadena[pos] )
+		{
+			
+			case -70:
+				strcat( cadena_corregida , "º" );
+				break;
+			case -13:
+				strcat( cadena_corregida , "ó" );
+				break;
+			case -19:
+				strcat( cadena_corregida , "í" );
+				break;
+			case 13:
+				cadena_corregida[pos + correcciones] = '\n';
+				break;
+			default:
+				cadena_corregida[pos + correcciones] = cadena[pos];
+			
+		}
+		
+	}
+	
+	return cadena_corregida;
+	
+}
+
+/**
+ * @brief Posición del siguiente caracter 'c' a partir de 'desde' o el
+ * fin de los datos si no lo encuentra
+ */
+long unsigned int BD_Siguiente
+( bd * base , long unsigned int desde , char c )
+{
+	
+	if( desde >= base->tam )
+		return base->tam;
+	
+	char separador[2] = { c , '\0' };
+	const char * encontrado = Simd_Buscar( &base->datos[desde] ,
+										   base->tam - desde ,
+										   separador );
+		if( encontrado == NULL )
+			return base->tam;
+	
+	return encontrado - base->datos;
+	
+}
+
+/**
+ * @brief Carga los nombres de las columnas (3ra fila) corrigiendo los
+ * símbolos del archivo
+ */
+text * BD_Cargar_cabecera( bd * base , long unsigned int inicio ,
+						   long unsigned int fin )
+{
+	
+	char * linea3 = Mem_Create_string( fin - inicio );
+	memcpy( linea3 , &base->datos[inicio] , fin - inicio );
+	linea3[fin - inicio] = '\0';
+	char * linea3_mem = linea3;
+	linea3 = Corregir_simbolos_FREE( linea3 );
+	Mem_desassign( (void **)&linea3_mem );
+	linea3_mem = linea3;
+	
+	unsigned int cantidad_de_columnas;
+	cantidad_de_columnas = String_Cantidad_de_columnas( linea3 , "," );
+	text * cabecera = Mem_Create_text_null( cantidad_de_columnas );
+	
+	unsigned int pos_cab;
+	for( pos_cab = 0 ; pos_cab < cabecera->parts ; pos_cab++ )
+		cabecera->t[pos_cab] = String_Cortar_hasta_FREE( &linea3 ,
+														 "," );
+	
+	Mem_desassign( (void **)&linea3_mem );
+	
+	return cabecera;
+	
+}
+
+/**
+ * @brief Compara el primer campo de la fila con el número de estación
+ *
+ * @return 0 si son iguales
+ */
+int BD_Comparar_numero( vista fila , char * numero )
+{
+	
+	unsigned int largo = strlen( numero );
+	
+	if( largo >= fila.largo )
+		return 1;
+	if( !String_Vista_empieza_con( fila , numero ) )
+		return 1;
+	
+	return fila.inicio[largo] != ',';
+	
+}
+
+/**
+ * @brief Busca una estación por su número
+ *
+ * @return estación o NULL si no existe
+ */
+estacion * BD_Buscar_estacion( bd * base , char * numero )
+{
+	
+	if( base == NULL || numero == NULL )
+		return NULL;
+	
+	long unsigned int pos;
+	for( pos = 0 ; pos < base->cant_estaciones ; pos++ )
+		if( strcmp( base->estaciones[pos].numero , numero ) == 0 )
+			return &base->estaciones[pos];
+	
+	return NULL;
+	
+}
+
+/**
+ * @brief Busca una variable por su nombre en la cabecera, completo o
+ * sin la unidad entre corchetes y sin distinguir mayúsculas
+ *
+ * @return número de variable (desde 0) o -1 si no existe
+ */
+int BD_Buscar_variable( bd * base , char * nombre )
+{
+	
+	if( base == NULL || nombre == NULL )
+		return -1;
+	
+	unsigned int largo = strlen( nombre );
+	unsigned int variable;
+	for( variable = 0 ; variable < base->variables ; variable++ )
+	{
+		
+		char * columna;
+		columna = base->cabecera->t[BD_PRIMER_VARIABLE + variable];
+		if( strcasecmp( columna , nombre ) == 0 )
+			return variable;
+		char * unidad = strstr( columna , " [" );
+		if( unidad != NULL && unidad - columna == largo &&
+			strncasecmp( columna , nombre , largo ) == 0 )
+			return variable;
+		
+	}
+	
+	return -1;
+	
+}
+
+/**
+ * @brief Estación a la que pertenece una fila según su primer campo;
+ * si es la primera fila de la estación la agrega a la tabla
+ *
+ * @param linea : fila completa
+ */
+estacion * BD_Estacion_de_fila( bd * base , vista linea )
+{
+	
+	///Lo habitual es que siga la estación de la fila anterior
+	if( base->ultima_estacion < base->cant_estaciones )
+	{
+		
+		estacion * ultima = &base->estaciones[base->ultima_estacion];
+		if( BD_Comparar_numero( linea , ultima->numero ) == 0 )
+			return ultima;
+		
+	}
+	
+	long unsigned int pos;
+	for( pos = 0 ; pos < base->cant_estaciones ; pos++ )
+		if( BD_Comparar_numero( linea ,
+								base->estaciones[pos].numero ) == 0 )
+		{
+			
+			base->ultima_estacion = pos;
+			return &base->estaciones[pos];
+			
+		}
+	
+	if( base->cant_estaciones == base->estaciones_asignadas )
+	{
+		
+		base->estaciones_asignadas = base->estaciones_asignadas * 2 + 8;
+		base->estaciones = Mem_reassign( base->estaciones ,
+										 base->estaciones_asignadas *
+										 sizeof( estacion ) );
+		
+	}
+	
+	base->ultima_estacion = base->cant_estaciones++;
+	estacion * nueva = &base->estaciones[base->ultima_estacion];
+	memset( nueva , 0 , sizeof( estacion ) );
+	nueva->ultimo_tiempo = BD_SIN_FECHA;
+	nueva->ordenado = 1;
+	nueva->distribuciones = Mem_assign_vector_zeros(
+											base->variables + 1 ,
+											sizeof( cuantiles ) );
+	vista campo = String_Vista( NULL , 0 );
+	String_Siguiente_campo( &linea , "," , &campo );
+	nueva->numero = String_Vista_copiar_FREE( campo );
+	campo = String_Vista( NULL , 0 );
+	String_Siguiente_campo( &linea , "," , &campo );
+	nueva->nombre = String_Vista_copiar_FREE( campo );
+	
+	return nueva;
+	
+}
+
+/**
+ * @brief Agrega una fila al último tramo de la estación si es continua
+ * a él o de lo contrario abre un tramo nuevo, al final del orden
+ *
+ * @param inicio : desplazamiento de la fila en los datos
+ * @param siguiente : desplazamiento de la fila siguiente
+ */
+void BD_Agregar_a_tramo( bd * base , estacion * est ,
+						 long unsigned int fila ,
+						 long unsigned int inicio ,
+						 long unsigned int siguiente )
+{
+	
+	if( est->cant_tramos > 0 )
+	{
+		
+		tramo * ultimo = &est->tramos[est->cant_tramos - 1];
+		if( ultimo->primera_fila + ultimo->filas == fila )
+		{
+			
+			ultimo->largo = siguiente - ultimo->inicio;
+			ultimo->filas++;
+			return;
+			
+		}
+		
+	}
+	
+	if( est->cant_tramos == est->tramos_asignados )
+	{
+		
+		est->tramos_asignados = est->tramos_asignados * 2 + 1;
+		est->tramos = Mem_reassign( est->tramos ,
+									est->tramos_asignados *
+									sizeof( tramo ) );
+		
+	}
+	
+	tramo * nuevo = &est->tramos[est->cant_tramos++];
+	nuevo->inicio = inicio;
+	nuevo->largo = siguiente - inicio;
+	nuevo->primera_fila = fila;
+	nuevo->filas = 1;
+	
+	if( base->cant_orden == base->orden_asignados )
+	{
+		
+		base->orden_asignados = base->orden_asignados * 2 + 32;
+		base->orden = Mem_reassign( base->orden ,
+									base->orden_asignados *
+									sizeof( orden_tramo ) );
+		
+	}
+	base->orden[base->cant_orden].estacion = est - base->estaciones;
+	base->orden[base->cant_orden].tramo = est->cant_tramos - 1;
+	base->cant_orden++;
+	
+}
+
+/**
+ * @brief Agrega una fila al último segmento de la estación o abre uno
+ * nuevo si la fila no le sigue o empieza un bloque. Un segmento nuevo
+ * empieza en la última marca de la estación, así en una estación
+ * ordenada 'desde' y 'hasta' crecen de un segmento al siguiente
+ */
+void BD_Indexar_tiempo( estacion * est , long unsigned int fila ,
+						int64_t tiempo )
+{
+	
+	segmento * ultimo = NULL;
+	if( est->cant_segmentos > 0 )
+		ultimo = &est->segmentos[est->cant_segmentos - 1];
+	if( ultimo == NULL ||
+		ultimo->primera_fila + ultimo->filas != fila ||
+		fila % COMPRESION_BLOQUE == 0 )
+	{
+		
+		if( est->cant_segmentos == est->segmentos_asignados )
+		{
+			
+			est->segmentos_asignados = est->segmentos_asignados * 2 + 1;
+			est->segmentos = Mem_reassign( est->segmentos ,
+										   est->segmentos_asignados *
+										   sizeof( segmento ) );
+			
+		}
+		ultimo = &est->segmentos[est->cant_segmentos++];
+		ultimo->primera_fila = fila;
+		ultimo->filas = 0;
+		ultimo->desde = est->ultimo_tiempo;
+		ultimo->hasta = est->ultimo_tiempo;
+		
+	}
+	ultimo->filas++;
+	
+		if( tiempo == BD_SIN_FECHA )
+			return;
+	
+	if( tiempo < ultimo->desde )
+		ultimo->desde = tiempo;
+	if( tiempo > ultimo->hasta )
+		ultimo->hasta = tiempo;
+	if( tiempo < est->ultimo_tiempo )
+		est->ordenado = 0;
+	est->ultimo_tiempo = tiempo;
+	
+}
+
+/**
+ * @brief Asigna las columnas vacías de las variables de la cabecera y
+ * la de marcas de tiempo
+ */
+void BD_Crear_columnas( bd * base )
+{
+	
+	base->tiempos.cola = Mem_assign_vector( COMPRESION_BLOQUE ,
+											sizeof( int64_t ) );
+	base->columnas = Mem_assign_vector_zeros( base->variables + 1 ,
+											  sizeof( columna ) );
+	unsigned int variable;
+	for( variable = 0 ; variable < base->variables ; variable++ )
+		base->columnas[variable].cola =
+			Mem_assign_vector( COMPRESION_BLOQUE , sizeof( float ) );
+	
+}
+
+/**
+ * @brief Agrega el valor de la fila siguiente a la columna; al
+ * completarse un bloque lo comprime
+ */
+void BD_Agregar_valor( columna * c , long unsigned int fila ,
+					   float valor )
+{
+	
+	unsigned int pos = fila % COMPRESION_BLOQUE;
+	c->cola[pos] = valor;
+		if( pos != COMPRESION_BLOQUE - 1 )
+			return;
+	
+	if( c->cant_bloques == c->bloques_asignados )
+	{
+		
+		c->bloques_asignados = c->bloques_asignados * 2 + 16;
+		c->bloques = Mem_reassign( c->bloques ,
+								   c->bloques_asignados *
+								   sizeof( bloque_flotantes ) );
+		
+	}
+	Compresion_Comprimir_flotantes( c->cola ,
+									COMPRESION_BLOQUE ,
+									&c->bloques[c->cant_bloques++] );
+	
+}
+
+/**
+ * @brief Agrega la marca de tiempo de la fila siguiente; al
+ * completarse un bloque lo comprime
+ */
+void BD_Agregar_tiempo( columna_tiempos * c , long unsigned int fila ,
+						int64_t tiempo )
+{
+	
+	unsigned int pos = fila % COMPRESION_BLOQUE;
+	c->cola[pos] = tiempo;
+		if( pos != COMPRESION_BLOQUE - 1 )
+			return;
+	
+	if( c->cant_bloques == c->bloques_asignados )
+	{
+		
+		c->bloques_asignados = c->bloques_asignados * 2 + 16;
+		c->bloques = Mem_reassign( c->bloques ,
+								   c->bloques_asignados *
+								   sizeof( bloque_enteros ) );
+		
+	}
+	Compresion_Comprimir_enteros( c->cola ,
+								  COMPRESION_BLOQUE ,
+								  &c->bloques[c->cant_bloques++] );
+	
+}
+
+/**
+ * @brief Convierte un campo numérico, "--" o vacío es NAN
+ */
+float BD_Valor( vista campo )
+{
+	
+	if( String_Vista_empieza_con( campo , "--" ) )
+		return NAN;
+	
+	float valor;
+	if( !String_Vista_a_flotante( campo , &valor ) )
+		return NAN;
+	
+	return valor;
+	
+}
+
+/**
+ * @brief Suma un valor al último acumulado de la tabla si es de la
+ * misma fecha o de lo contrario abre uno nuevo
+ */
+void BD_Acumular( acumulados * tabla , long int clave , float valor )
+{
+	
+	if( tabla->cant == 0 || tabla->a[tabla->cant - 1].clave != clave )
+	{
+		
+		if( tabla->cant == tabla->asignados )
+		{
+			
+			tabla->asignados = tabla->asignados * 2 + 32;
+			tabla->a = Mem_reassign( tabla->a ,
+									 tabla->asignados *
+									 sizeof( acumulado ) );
+			
+		}
+		tabla->a[tabla->cant].clave = clave;
+		tabla->a[tabla->cant].acumulado = 0;
+		tabla->cant++;
+		
+	}
+	tabla->a[tabla->cant - 1].acumulado += valor;
+	
+}
+
+/**
+ * @brief Suma la precipitación de la fila a los acumulados diario y
+ * mensual de su estación ("--" cuenta como 0)
+ */
+void BD_Acumular_precipitacion( bd * base , estacion * est ,
+								int64_t tiempo , float precipitacion )
+{
+	
+		if( BD_COLUMNA_PRECIPITACION - BD_PRIMER_VARIABLE
+			>= base->variables || tiempo == BD_SIN_FECHA )
+			return;
+	
+	if( isnan( precipitacion ) )
+		precipitacion = 0;
+	
+	///El mes solo se calcula al cambiar de día
+	long int dia = Fecha_Dia( tiempo );
+	long int mes;
+	acumulados * dias = &est->dias;
+	if( dias->cant > 0 && dias->a[dias->cant - 1].clave == dia )
+		mes = est->meses.a[est->meses.cant - 1].clave;
+	else
+		mes = Fecha_Mes( dia );
+	BD_Acumular( &est->dias , dia , precipitacion );
+	BD_Acumular( &est->meses , mes , precipitacion );
+	
+}
+
+/**
+ * Filas de un tramo de bytes del archivo leídas por un hilo: sus
+ * valores quedan en columnas propias hasta pasarlos a los de la base
+ */
+typedef struct {
+	
+	long unsigned int inicio; /// desplazamiento en los datos
+	long unsigned int fin; /// después de su último fin de fila
+	long unsigned int filas;
+	long unsigned int primera_fila; /// número en la base, al unirlo
+	long unsigned int * inicios; /// de cada fila
+	long unsigned int * fines;
+	int64_t * tiempos;
+	matrix * valores; /// por columnas: valores->m[variable][fila]
+	long unsigned int * estaciones; /// de cada fila, al unirlo
+	
+} bd_fragmento;
+
+typedef struct {
+	
+	bd * base;
+	bd_fragmento * fragmentos;
+	unsigned int cant;
+	
+} bd_carga;
+
+/**
+ * @brief Separa una fila de datos en su marca de tiempo y sus valores
+ *
+ * @param valores : columnas del fragmento, se escribe la fila 'pos'
+ */
+void BD_Leer_fila( bd * base , vista linea , int64_t * tiempo ,
+				   float ** valores , long unsigned int pos )
+{
+	
+	///Salteo número, nombre y localidad hasta la fecha
+	vista resto = linea;
+	String_Saltear_campos( &resto , "," , BD_COLUMNA_FECHA );
+	vista campo;
+	if( !String_Siguiente_campo( &resto , "," , &campo ) ||
+		!Fecha_Leer( campo , tiempo ) )
+		*tiempo = BD_SIN_FECHA;
+	
+	unsigned int variable;
+	for( variable = 0 ; variable < base->variables ; variable++ )
+	{
+		
+		float valor = NAN;
+		if( String_Siguiente_campo( &resto , "," , &campo ) )
+			valor = BD_Valor( campo );
+		valores[variable][pos] = valor;
+		
+	}
+	
+}
+
+/**
+ * @brief Ubica las filas del fragmento y luego las lee en sus columnas
+ * propias; no toca la base, así los hilos no se sincronizan
+ */
+void BD_Leer_fragmento( bd * base , bd_fragmento * f )
+{
+	
+	size_t inicios_asignados = 0 , fines_asignados = 0;
+	long unsigned int inicio = f->inicio;
+	while( inicio < f->fin )
+	{
+		
+		long unsigned int fin;
+		fin = BD_Siguiente( base , inicio , BD_FIN_DE_FILA );
+		if( fin > inicio )
+		{
+			
+			size_t bytes = ( f->filas + 1 ) *
+						   sizeof( long unsigned int );
+			f->inicios = Mem_grow( f->inicios , &inicios_asignados ,
+								   bytes );
+			f->fines = Mem_grow( f->fines , &fines_asignados , bytes );
+			f->inicios[f->filas] = inicio;
+			f->fines[f->filas] = fin;
+			f->filas++;
+			
+		}
+		inicio = fin + 1;
+		
+	}
+	
+	f->tiempos = Mem_assign_vector( f->filas + 1 , sizeof( int64_t ) );
+	f->estaciones = Mem_assign_vector( f->filas + 1 ,
+									   sizeof( long unsigned int ) );
+	f->valores = Mem_Create_matrix_layout( f->filas ,
+										   base->variables ,
+										   sizeof( float ) ,
+										   MEM_COLUMN_MAJOR );
+	long unsigned int pos;
+	for( pos = 0 ; pos < f->filas ; pos++ )
+	{
+		
+		vista linea = String_Vista( &base->datos[f->inicios[pos]] ,
+									f->fines[pos] - f->inicios[pos] );
+		BD_Leer_fila( base , linea , &f->tiempos[pos] ,
+					  (float **)f->valores->m , pos );
+		
+	}
+	
+}
+
+void BD_Leer_fragmentos( void * contexto , unsigned int hilo ,
+						 long unsigned int inicio ,
+						 long unsigned int fin )
+{
+	
+	(void)hilo;
+	bd_carga * carga = contexto;
+	for( ; inicio < fin ; inicio++ )
+		BD_Leer_fragmento( carga->base ,
+						   &carga->fragmentos[inicio] );
+	
+}
+
+/**
+ * @brief Numera las filas del fragmento a continuación de las de la
+ * base y las agrega a sus estaciones (tramos, índice de tiempo y
+ * acumulados), en el orden del archivo
+ */
+void BD_Unir_fragmento( bd * base , bd_fragmento * f )
+{
+	
+	float ** valores = (float **)f->valores->m;
+	f->primera_fila = base->filas;
+	long unsigned int pos;
+	for( pos = 0 ; pos < f->filas ; pos++ )
+	{
+		
+		long unsigned int fila = base->filas++;
+		long unsigned int inicio = f->inicios[pos];
+		long unsigned int fin = f->fines[pos];
+		vista linea = String_Vista( &base->datos[inicio] ,
+									fin - inicio );
+		estacion * actual = BD_Estacion_de_fila( base , linea );
+		BD_Agregar_a_tramo( base ,
+							actual ,
+							fila ,
+							inicio ,
+							fin < base->tam ? fin + 1 : fin );
+		actual->filas++;
+		f->estaciones[pos] = actual - base->estaciones;
+		BD_Indexar_tiempo( actual , fila , f->tiempos[pos] );
+		
+		unsigned int variable;
+		for( variable = 0 ;
+			 actual->filas == 1 && variable < base->variables ;
+			 variable++ )
+			if( !isnan( valores[variable][pos] ) )
+				actual->campos++;
+		
+		float precipitacion = NAN;
+		if( BD_COLUMNA_PRECIPITACION - BD_PRIMER_VARIABLE <
+			base->variables )
+			precipitacion = valores[BD_COLUMNA_PRECIPITACION -
+									BD_PRIMER_VARIABLE][pos];
+		BD_Acumular_precipitacion( base , actual , f->tiempos[pos] ,
+								   precipitacion );
+		
+	}
+	
+}
+
+/**
+ * @brief Pasa a la base las columnas [inicio , fin) de todos los
+ * fragmentos, en orden: cada columna la comprime y resume un solo
+ * hilo, así el resultado es el mismo que cargando de a una fila. La
+ * columna 'variables' es la de marcas de tiempo
+ */
+void BD_Pasar_columnas( void * contexto , unsigned int hilo ,
+						long unsigned int inicio ,
+						long unsigned int fin )
+{
+	
+	(void)hilo;
+	bd_carga * carga = contexto;
+	bd * base = carga->base;
+	for( ; inicio < fin ; inicio++ )
+	{
+		
+		unsigned int n;
+		for( n = 0 ; n < carga->cant ; n++ )
+		{
+			
+			bd_fragmento * f = &carga->fragmentos[n];
+			long unsigned int pos;
+			if( inicio == base->variables )
+			{
+				
+				for( pos = 0 ; pos < f->filas ; pos++ )
+					BD_Agregar_tiempo( &base->tiempos ,
+									   f->primera_fila + pos ,
+									   f->tiempos[pos] );
+				continue;
+				
+			}
+			
+			float * valores = f->valores->m[inicio];
+			columna * c = &base->columnas[inicio];
+			for( pos = 0 ; pos < f->filas ; pos++ )
+			{
+				
+				BD_Agregar_valor( c , f->primera_fila + pos ,
+								  valores[pos] );
+				estacion * est = &base->estaciones[f->estaciones[pos]];
+				if( !isnan( valores[pos] ) )
+					Cuantiles_Agregar( &est->distribuciones[inicio] ,
+									   valores[pos] );
+				
+			}
+			
+		}
+		
+		///Sin pendientes, consultar un resumen no lo modifica y varios
+		///pedidos pueden hacerlo a la vez
+		if( inicio < base->variables )
+		{
+			
+			long unsigned int pos;
+			for( pos = 0 ; pos < base->cant_estaciones ; pos++ )
+				Cuantiles_Comprimir(
+					&base->estaciones[pos].distribuciones[inicio] );
+			
+		}
+		
+	}
+	
+}
+
+/**
+ * @brief Fin de la última fila completa entre 'desde' y el fin de los
+ * datos, o 'desde' si no hay ninguna
+ */
+long unsigned int BD_Fin_de_filas( bd * base , long unsigned int desde )
+{
+	
+	long unsigned int fin = base->tam;
+	while( fin > desde && base->datos[fin - 1] != BD_FIN_DE_FILA )
+		fin--;
+	
+	return fin;
+	
+}
+
+/**
+ * @brief Firma (FNV-1a de 64 bits) de los bytes [inicio , fin) de los
+ * datos
+ */
+uint64_t BD_Firma( bd * base , long unsigned int inicio ,
+				   long unsigned int fin )
+{
+	
+	uint64_t firma = 14695981039346656037ULL;
+	for( ; inicio < fin ; inicio++ )
+	{
+		
+		firma ^= (unsigned char)base->datos[inicio];
+		firma *= 1099511628211ULL;
+		
+	}
+	
+	return firma;
+	
+}
+
+/**
+ * @brief Guarda las firmas de la cabecera y de la última fila
+ * procesada, con las que BD_Sin_reescribir reconoce un archivo que se
+ * volvió a escribir en su lugar
+ */
+void BD_Firmar( bd * base )
+{
+	
+	long unsigned int desde = base->procesado;
+	if( desde > base->inicio_datos )
+		desde--;
+	while( desde > base->inicio_datos &&
+		   base->datos[desde - 1] != BD_FIN_DE_FILA )
+		desde--;
+	base->ultima_fila = desde;
+	base->firma_cabecera = BD_Firma( base , 0 , base->inicio_datos );
+	base->firma_ultima_fila = BD_Firma( base , desde ,
+										base->procesado );
+	
+}
+
+/**
+ * @brief Indica si lo ya procesado sigue en el archivo: si no, lo que
+ * creció no son filas agregadas sino otro contenido
+ */
+int BD_Sin_reescribir( bd * base )
+{
+	
+		if( base->procesado > base->tam )
+			return 0;
+		if( base->procesado > base->inicio_datos &&
+			base->datos[base->procesado - 1] != BD_FIN_DE_FILA )
+			return 0;
+	
+	return BD_Firma( base , 0 , base->inicio_datos ) ==
+		   base->firma_cabecera &&
+		   BD_Firma( base , base->ultima_fila , base->procesado ) ==
+		   base->firma_ultima_fila;
+	
+}
+
+/**
+ * @brief Carga las filas completas (terminadas en BD_FIN_DE_FILA)
+ * desde lo ya procesado hasta el fin de los datos; una última fila sin
+ * terminar queda pendiente hasta que se complete. Los bytes se reparten
+ * en fragmentos que terminan en un fin de fila y se leen en paralelo;
+ * luego se unen en orden y cada columna se llena en su propio hilo
+ *
+ * @return cantidad de filas cargadas
+ */
+long unsigned int BD_Cargar_filas( bd * base )
+{
+	
+	long unsigned int filas = base->filas;
+	long unsigned int inicio = base->procesado;
+	long unsigned int fin = BD_Fin_de_filas( base , inicio );
+		if( fin == inicio )
+			return 0;
+	
+	bd_fragmento fragmentos[HILOS_MAXIMO];
+	bd_carga carga;
+	carga.base = base;
+	carga.fragmentos = fragmentos;
+	carga.cant = Hilos_Para( fin - inicio , BD_BYTES_POR_HILO );
+	unsigned int n;
+	for( n = 0 ; n < carga.cant ; n++ )
+	{
+		
+		memset( &fragmentos[n] , 0 , sizeof( bd_fragmento ) );
+		fragmentos[n].inicio = n == 0 ? inicio : fragmentos[n - 1].fin;
+		fragmentos[n].fin = fin;
+		long unsigned int limite;
+		limite = inicio + ( fin - inicio ) / carga.cant * ( n + 1 );
+		if( n + 1 < carga.cant && limite > fragmentos[n].inicio )
+			fragmentos[n].fin = BD_Siguiente( base , limite ,
+											  BD_FIN_DE_FILA ) + 1;
+		else if( n + 1 < carga.cant )
+			fragmentos[n].fin = fragmentos[n].inicio;
+		
+	}
+	
+	Hilos_Repartir( carga.cant , carga.cant , BD_Leer_fragmentos ,
+					&carga );
+	for( n = 0 ; n < carga.cant ; n++ )
+		BD_Unir_fragmento( base , &fragmentos[n] );
+	unsigned int hilos = carga.cant;
+	if( hilos > base->variables + 1 )
+		hilos = base->variables + 1;
+	Hilos_Repartir( base->variables + 1 , hilos , BD_Pasar_columnas ,
+					&carga );
+	
+	for( n = 0 ; n < carga.cant ; n++ )
+	{
+		
+		Mem_desassign( (void **)&fragmentos[n].inicios );
+		Mem_desassign( (void **)&fragmentos[n].fines );
+		Mem_desassign( (void **)&fragmentos[n].tiempos );
+		Mem_desassign( (void **)&fragmentos[n].estaciones );
+		Mem_Delete_matrix( &fragmentos[n].valores );
+		
+	}
+	base->procesado = fin;
+	BD_Firmar( base );
+	if( base->filas > filas )
+		base->version++;
+	
+	return base->filas - filas;
+	
+}
+
+/**
+ * @brief Lee el archivo de datos completo y lo separa en columnas
+ *
+ * @param ruta : archivo de la base de datos
+ * @return base cargada o NULL si no se pudo leer
+ */
+bd * BD_Cargar( char * ruta )
+{
+	
+	file_map * archivo = File_map_open_reserved( ruta , BD_RESERVA );
+		if( archivo == NULL )
+			return NULL;
+	
+	bd * base = Mem_assign( sizeof( bd ) );
+	memset( base , 0 , sizeof( bd ) );
+	base->archivo = archivo;
+	base->datos = archivo->data;
+	base->tam = archivo->size;
+	base->vigilancia = -1;
+	
+	///Salteo las dos primeras filas y cargo la cabecera
+	char * linea = NULL;
+	long unsigned int largo = 0;
+	unsigned int fila;
+	for( fila = 0 ; fila < BD_FILAS_DE_CABECERA ; fila++ )
+		if( !File_map_next_line( archivo , BD_FIN_DE_FILA ,
+								 &linea , &largo ) )
+			break;
+	long unsigned int inicio = linea == NULL ? 0 : linea - base->datos;
+	base->cabecera = BD_Cargar_cabecera( base ,
+										 inicio ,
+										 inicio + largo );
+	base->inicio_datos = archivo->position;
+	base->procesado = archivo->position;
+	base->variables = 0;
+	if( base->cabecera->parts > BD_PRIMER_VARIABLE )
+		base->variables = base->cabecera->parts - BD_PRIMER_VARIABLE;
+	BD_Crear_columnas( base );
+	
+	///Separo cada fila en sus columnas sin copiarla
+	BD_Firmar( base );
+	BD_Cargar_filas( base );
+	
+	return base;
+	
+}
+
+/**
+ * @brief Comienza a vigilar el archivo para cargar las filas que se le
+ * agreguen (ver BD_Actualizar)
+ *
+ * @return 0 o -1 si no se puede vigilar
+ */
+int BD_Seguir( bd * base , char * ruta )
+{
+	
+	if( base == NULL )
+		return -1;
+	
+	base->vigilancia = File_watch_open( ruta );
+	if( base->vigilancia >= 0 )
+		base->ruta = String_Crear( ruta );
+	
+	return base->vigilancia < 0 ? -1 : 0;
+	
+}
+
+/**
+ * @brief Carga solo los bytes agregados al archivo desde la última
+ * vez; las estaciones, tramos y acumulados se actualizan en su lugar
+ *
+ * @return filas nuevas o -1 si el archivo fue reemplazado, acortado,
+ * reescrito en su lugar o superó la reserva, en cuyo caso hay que
+ * volver a cargarlo
+ */
+long int BD_Actualizar( bd * base )
+{
+	
+	if( base == NULL || base->vigilancia < 0 )
+		return 0;
+	
+	unsigned int eventos = File_watch_events( base->vigilancia );
+		if( eventos == 0 )
+			return 0;
+		if( eventos & IN_IGNORED )
+			return -1;
+		if( !File_map_is( base->archivo , base->ruta ) )
+			return -1;
+		if( !( eventos & IN_MODIFY ) )
+			return 0;
+	
+	long int agregado = File_map_grow( base->archivo );
+		if( agregado < 0 )
+			return -1;
+	base->datos = base->archivo->data;
+	base->tam = base->archivo->size;
+		if( !BD_Sin_reescribir( base ) )
+			return -1;
+	
+	return BD_Cargar_filas( base );
+	
+}
+
+/**
+ * @brief Indica, sin consumir los eventos, si el archivo cambió desde
+ * la última BD_Actualizar: solo entonces hace falta llamarla
+ */
+int BD_Cambiado( bd * base )
+{
+	
+	if( base == NULL || base->vigilancia < 0 )
+		return 0;
+	
+	return File_watch_pending( base->vigilancia );
+	
+}
+
+void BD_Eliminar( bd ** base )
+{
+	
+	if( *base == NULL )
+		return;
+	
+	long unsigned int pos;
+	for( pos = 0 ; pos < (*base)->cant_estaciones ; pos++ )
+	{
+		
+		estacion * est = &(*base)->estaciones[pos];
+		Mem_desassign( (void **)&est->numero );
+		Mem_desassign( (void **)&est->nombre );
+		Mem_desassign( (void **)&est->tramos );
+		Mem_desassign( (void **)&est->dias.a );
+		Mem_desassign( (void **)&est->meses.a );
+		Mem_desassign( (void **)&est->segmentos );
+		unsigned int variable;
+		for( variable = 0 ;
+			 est->distribuciones != NULL &&
+			 variable < (*base)->variables ;
+			 variable++ )
+			Cuantiles_Liberar( &est->distribuciones[variable] );
+		Mem_desassign( (void **)&est->distribuciones );
+		
+	}
+	Mem_desassign( (void **)&(*base)->estaciones );
+	
+	unsigned int variable;
+	for( variable = 0 ; variable < (*base)->variables ; variable++ )
+	{
+		
+		columna * c = &(*base)->columnas[variable];
+		long unsigned int bloque;
+		for( bloque = 0 ; bloque < c->cant_bloques ; bloque++ )
+			Compresion_Liberar_flotantes( &c->bloques[bloque] );
+		Mem_desassign( (void **)&c->bloques );
+		Mem_desassign( (void **)&c->cola );
+		
+	}
+	Mem_desassign( (void **)&(*base)->columnas );
+	Mem_desassign( (void **)&(*base)->orden );
+	
+	columna_tiempos * tiempos = &(*base)->tiempos;
+	long unsigned int bloque;
+	for( bloque = 0 ; bloque < tiempos->cant_bloques ; bloque++ )
+		Compresion_Liberar_enteros( &tiempos->bloques[bloque] );
+	Mem_desassign( (void **)&tiempos->bloques );
+	Mem_desassign( (void **)&tiempos->cola );
+	if( (*base)->cabecera != NULL )
+		Mem_Delete_text( &(*base)->cabecera );
+	if( (*base)->vigilancia >= 0 )
+		close( (*base)->vigilancia );
+	Mem_desassign( (void **)&(*base)->ruta );
+	File_map_close( &(*base)->archivo );
+	Mem_desassign( (void **)base );
+	
+}
+
+/**
+ * @brief Cantidad de bloques de las columnas, incluido el incompleto
+ */
+long unsigned int BD_Cantidad_de_bloques( bd * base )
+{
+	
+	return ( base->filas + COMPRESION_BLOQUE - 1 ) / COMPRESION_BLOQUE;
+	
+}
+
+/**
+ * @brief Valores de un bloque de una columna: los comprimidos se
+ * descomprimen en 'buffer', el incompleto se lee en su lugar
+ *
+ * @param buffer : vector de al menos COMPRESION_BLOQUE flotantes
+ * @param valores : devuelve el inicio de los valores del bloque
+ * @return cantidad de filas del bloque
+ */
+unsigned int BD_Bloque( bd * base , unsigned int variable ,
+						long unsigned int bloque , float * buffer ,
+						const float ** valores )
+{
+	
+	columna * c = &base->columnas[variable];
+	if( bloque < c->cant_bloques )
+	{
+		
+		*valores = buffer;
+		return Compresion_Descomprimir_flotantes( &c->bloques[bloque] ,
+												  buffer );
+		
+	}
+	
+	*valores = c->cola;
+	
+	return base->filas - c->cant_bloques * COMPRESION_BLOQUE;
+	
+}
+
+/**
+ * @brief Marcas de tiempo de un bloque, como BD_Bloque
+ *
+ * @param buffer : vector de al menos COMPRESION_BLOQUE enteros
+ */
+unsigned int BD_Bloque_de_tiempos( bd * base ,
+								   long unsigned int bloque ,
+								   int64_t * buffer ,
+								   const int64_t ** tiempos )
+{
+	
+	columna_tiempos * c = &base->tiempos;
+	if( bloque < c->cant_bloques )
+	{
+		
+		*tiempos = buffer;
+		return Compresion_Descomprimir_enteros( &c->bloques[bloque] ,
+												buffer );
+		
+	}
+	
+	*tiempos = c->cola;
+	
+	return base->filas - c->cant_bloques * COMPRESION_BLOQUE;
+	
+}
+
+/**
+ * @brief Tramo de la posición 'pos' del orden
+ */
+tramo * BD_Tramo_en_orden( bd * base , long unsigned int pos )
+{
+	
+	orden_tramo * o = &base->orden[pos];
+	
+	return &base->estaciones[o->estacion].tramos[o->tramo];
+	
+}
+
+/**
+ * @brief Posición en el orden del tramo que contiene la fila (búsqueda
+ * binaria, los tramos están ordenados por su primera fila)
+ */
+long unsigned int BD_Buscar_en_orden( bd * base ,
+									  long unsigned int fila )
+{
+	
+	long unsigned int desde = 0;
+	long unsigned int hasta = base->cant_orden;
+	while( hasta - desde > 1 )
+	{
+		
+		long unsigned int medio = desde + ( hasta - desde ) / 2;
+		if( BD_Tramo_en_orden( base , medio )->primera_fila <= fila )
+			desde = medio;
+		else
+			hasta = medio;
+		
+	}
+	
+	return desde;
+	
+}
+
+/**
+ * @brief Recibe filas consecutivas de una misma estación
+ *
+ * @param hilo : número del hilo que recorre (para parciales por hilo)
+ * @param valores : 'cantidad' valores desde 'primera_fila'
+ */
+typedef void ( * bd_visitante )( void * contexto ,
+								 unsigned int hilo ,
+								 long unsigned int estacion ,
+								 long unsigned int primera_fila ,
+								 const float * valores ,
+								 long unsigned int cantidad );
+
+/**
+ * @brief Recorre los bloques [desde , hasta) de una columna
+ * descomprimiéndolos de a uno y entregando al visitante cada parte de
+ * un tramo de estación que cae en el bloque
+ */
+void BD_Recorrer_bloques( bd * base , unsigned int variable ,
+						  long unsigned int desde ,
+						  long unsigned int hasta ,
+						  bd_visitante visitar , void * contexto ,
+						  unsigned int hilo )
+{
+	
+		if( desde >= hasta || base->cant_orden == 0 )
+			return;
+	
+	float * buffer = Mem_assign_vector( COMPRESION_BLOQUE ,
+										sizeof( float ) );
+	long unsigned int pos;
+	pos = BD_Buscar_en_orden( base , desde * COMPRESION_BLOQUE );
+	
+	long unsigned int bloque;
+	for( bloque = desde ; bloque < hasta ; bloque++ )
+	{
+		
+		const float * valores;
+		long unsigned int primera = bloque * COMPRESION_BLOQUE;
+		long unsigned int fin = primera + BD_Bloque( base ,
+													 variable ,
+													 bloque ,
+													 buffer ,
+													 &valores );
+		for( ; pos < base->cant_orden ; pos++ )
+		{
+			
+			tramo * t = BD_Tramo_en_orden( base , pos );
+			long unsigned int inicio = t->primera_fila;
+			long unsigned int fin_tramo = t->primera_fila + t->filas;
+			long unsigned int hasta_fila = fin_tramo;
+			if( hasta_fila > fin )
+				hasta_fila = fin;
+			if( inicio < primera )
+				inicio = primera;
+			if( inicio < hasta_fila )
+				visitar( contexto ,
+						 hilo ,
+						 base->orden[pos].estacion ,
+						 inicio ,
+						 &valores[inicio - primera] ,
+						 hasta_fila - inicio );
+			///El tramo sigue en el bloque siguiente
+			if( fin_tramo > fin )
+				break;
+			
+		}
+		
+	}
+	
+	Mem_desassign( (void **)&buffer );
+	
+}
+
+typedef struct {
+	
+	bd * base;
+	unsigned int variable;
+	bd_visitante visitar;
+	void * contexto;
+	
+} bd_recorrido;
+
+void BD_Recorrer_tramo_de_bloques( void * contexto , unsigned int hilo ,
+								   long unsigned int inicio ,
+								   long unsigned int fin )
+{
+	
+	bd_recorrido * r = contexto;
+	BD_Recorrer_bloques( r->base , r->variable , inicio , fin ,
+						 r->visitar , r->contexto , hilo );
+	
+}
+
+/**
+ * @brief Hilos con los que conviene recorrer una columna completa
+ */
+unsigned int BD_Hilos( bd * base )
+{
+	
+	return Hilos_Para( base->filas , BD_FILAS_POR_HILO );
+	
+}
+
+/**
+ * @brief Recorre una columna completa repartiendo sus bloques entre
+ * 'hilos' hilos (ver BD_Hilos); cada hilo visita tramos contiguos
+ */
+void BD_Recorrer_columna( bd * base , unsigned int variable ,
+						  unsigned int hilos ,
+						  bd_visitante visitar , void * contexto )
+{
+	
+		if( variable >= base->variables )
+			return;
+	
+	bd_recorrido r;
+	r.base = base;
+	r.variable = variable;
+	r.visitar = visitar;
+	r.contexto = contexto;
+	Hilos_Repartir( BD_Cantidad_de_bloques( base ) ,
+					hilos ,
+					BD_Recorrer_tramo_de_bloques ,
+					&r );
+	
+}
+
+/**
+ * @brief Recibe una fila de una búsqueda por fecha
+ */
+typedef void ( * bd_visitante_fila )( void * contexto ,
+									  int64_t tiempo ,
+									  float valor );
+
+/**
+ * @brief Visita, en el orden del archivo, las filas de una estación
+ * con marca de tiempo en [desde , hasta]. Con los segmentos ordenados
+ * el primero que puede coincidir se busca de forma binaria y el
+ * recorrido termina en el primero posterior a 'hasta'; si no, se
+ * descartan por su rango. Solo se descomprimen los bloques de los
+ * segmentos que pueden coincidir
+ *
+ * @return cantidad de filas visitadas
+ */
+long unsigned int BD_Buscar_rango( bd * base , estacion * est ,
+								   unsigned int variable ,
+								   int64_t desde , int64_t hasta ,
+								   bd_visitante_fila visitar ,
+								   void * contexto )
+{
+	
+	unsigned int pos = 0;
+	if( est->ordenado )
+	{
+		
+		unsigned int fin = est->cant_segmentos;
+		while( pos < fin )
+		{
+			
+			unsigned int medio = pos + ( fin - pos ) / 2;
+			if( est->segmentos[medio].hasta < desde )
+				pos = medio + 1;
+			else
+				fin = medio;
+			
+		}
+		
+	}
+	
+	float * buffer = Mem_assign_vector( COMPRESION_BLOQUE ,
+										sizeof( float ) );
+	int64_t * buffer_tiempos = Mem_assign_vector( COMPRESION_BLOQUE ,
+												  sizeof( int64_t ) );
+	const float * valores = NULL;
+	const int64_t * tiempos = NULL;
+	long unsigned int cargado = (long unsigned int)-1;
+	long unsigned int visitadas = 0;
+	for( ; pos < est->cant_segmentos ; pos++ )
+	{
+		
+		segmento * s = &est->segmentos[pos];
+		if( s->desde > hasta && est->ordenado )
+			break;
+		if( s->desde > hasta || s->hasta < desde )
+			continue;
+		
+		///Los segmentos de un mismo bloque suelen ser seguidos
+		long unsigned int bloque = s->primera_fila / COMPRESION_BLOQUE;
+		if( bloque != cargado )
+		{
+			
+			BD_Bloque( base , variable , bloque , buffer , &valores );
+			BD_Bloque_de_tiempos( base , bloque , buffer_tiempos ,
+								  &tiempos );
+			cargado = bloque;
+			
+		}
+		
+		long unsigned int fila = s->primera_fila % COMPRESION_BLOQUE;
+		long unsigned int fin = fila + s->filas;
+		for( ; fila < fin ; fila++ )
+			if( tiempos[fila] != BD_SIN_FECHA &&
+				tiempos[fila] >= desde && tiempos[fila] <= hasta )
+			{
+				
+				visitar( contexto , tiempos[fila] , valores[fila] );
+				visitadas++;
+				
+			}
+		
+	}
+	
+	Mem_desassign( (void **)&buffer );
+	Mem_desassign( (void **)&buffer_tiempos );
+	
+	return visitadas;
+	
+}
+
+///Largo de los grupos de 'BD_Agrupar'
+typedef enum { BD_POR_HORA , BD_POR_DIA , BD_POR_MES } bd_intervalo;
+
+///Filas de una estación que caen en una misma hora, día o mes
+typedef struct {
+	
+	long int clave; /// Fecha_Hora, Fecha_Dia o Fecha_Mes
+	long unsigned int filas;
+	long unsigned int datos; /// filas con valor
+	double suma;
+	float minimo;
+	float maximo;
+	
+} grupo;
+
+///Grupos ordenados por clave, en una pasada por las filas
+typedef struct {
+	
+	grupo * g;
+	unsigned int cant;
+	unsigned int asignados;
+	bd_intervalo intervalo;
+	long int ultimo_dia; /// para no recalcular el mes en cada fila
+	long int ultimo_mes;
+	
+} bd_grupos;
+
+/**
+ * @brief Grupo de la clave: el último si coincide (lo habitual en una
+ * estación ordenada), uno nuevo al final si es posterior o, si no, el
+ * que corresponde por búsqueda binaria, insertándolo si no existe
+ */
+grupo * BD_Grupo( bd_grupos * grupos , long int clave )
+{
+	
+	unsigned int pos = grupos->cant;
+	if( pos > 0 && grupos->g[pos - 1].clave >= clave )
+	{
+		
+			if( grupos->g[pos - 1].clave == clave )
+				return &grupos->g[pos - 1];
+		unsigned int desde = 0;
+		while( desde < pos )
+		{
+			
+			unsigned int medio = desde + ( pos - desde ) / 2;
+			if( grupos->g[medio].clave < clave )
+				desde = medio + 1;
+			else
+				pos = medio;
+			
+		}
+			if( grupos->g[pos].clave == clave )
+				return &grupos->g[pos];
+		
+	}
+	
+	if( grupos->cant == grupos->asignados )
+	{
+		
+		grupos->asignados = grupos->asignados * 2 + 32;
+		grupos->g = Mem_reassign( grupos->g ,
+								  grupos->asignados * sizeof( grupo ) );
+		
+	}
+	memmove( &grupos->g[pos + 1] , &grupos->g[pos] ,
+			 ( grupos->cant - pos ) * sizeof( grupo ) );
+	grupos->cant++;
+	
+	grupo * nuevo = &grupos->g[pos];
+	memset( nuevo , 0 , sizeof( grupo ) );
+	nuevo->clave = clave;
+	
+	return nuevo;
+	
+}
+
+void BD_Agrupar_fila( void * contexto , int64_t tiempo , float valor )
+{
+	
+	bd_grupos * grupos = contexto;
+	long int clave;
+	if( grupos->intervalo == BD_POR_HORA )
+		clave = Fecha_Hora( tiempo );
+	else
+	{
+		
+		clave = Fecha_Dia( tiempo );
+		if( grupos->intervalo == BD_POR_MES )
+		{
+			
+			if( clave != grupos->ultimo_dia || grupos->cant == 0 )
+			{
+				
+				grupos->ultimo_dia = clave;
+				grupos->ultimo_mes = Fecha_Mes( clave );
+				
+			}
+			clave = grupos->ultimo_mes;
+			
+		}
+		
+	}
+	
+	grupo * g = BD_Grupo( grupos , clave );
+	g->filas++;
+		if( isnan( valor ) )
+			return;
+	if( g->datos == 0 || valor < g->minimo )
+		g->minimo = valor;
+	if( g->datos == 0 || valor > g->maximo )
+		g->maximo = valor;
+	g->suma += valor;
+	g->datos++;
+	
+}
+
+/**
+ * @brief Agrupa por hora, día o mes las filas con fecha de una
+ * estación, en una sola pasada por la columna de la variable
+ *
+ * @param grupos : se inicializa; los grupos quedan en grupos->g, que
+ * debe liberar quien llama
+ */
+void BD_Agrupar( bd * base , estacion * est , unsigned int variable ,
+				 bd_intervalo intervalo , bd_grupos * grupos )
+{
+	
+	memset( grupos , 0 , sizeof( bd_grupos ) );
+	grupos->intervalo = intervalo;
+	BD_Buscar_rango( base , est , variable , INT64_MIN , INT64_MAX ,
+					 BD_Agrupar_fila , grupos );
+	
+}
+
+///Parciales de la suma de una columna, por hilo y estación
+typedef struct {
+	
+	long unsigned int estaciones;
+	double * sumas; /// [hilo * estaciones + estación]
+	size_t * cantidades;
+	
+} bd_suma;
+
+void BD_Sumar_valores( void * contexto , unsigned int hilo ,
+					   long unsigned int estacion ,
+					   long unsigned int primera_fila ,
+					   const float * valores ,
+					   long unsigned int cantidad )
+{
+	
+	(void)primera_fila;
+	bd_suma * suma = contexto;
+	long unsigned int pos = hilo * suma->estaciones + estacion;
+	suma->sumas[pos] += Simd_Sumar( valores ,
+									cantidad ,
+									&suma->cantidades[pos] );
+	
+}
+
+/**
+ * @brief Suma y cantidad de datos (sin "--") de una variable para cada
+ * estación, en una sola pasada por la columna repartida entre hilos
+ *
+ * @param sumas : vector de cant_estaciones elementos
+ * @param cantidades : vector de cant_estaciones elementos
+ */
+void BD_Sumar_variable( bd * base , unsigned int variable ,
+						double * sumas , size_t * cantidades )
+{
+	
+	long unsigned int estaciones = base->cant_estaciones;
+	memset( sumas , 0 , estaciones * sizeof( double ) );
+	memset( cantidades , 0 , estaciones * sizeof( size_t ) );
+		if( variable >= base->variables || estaciones == 0 )
+			return;
+	
+	unsigned int hilos = BD_Hilos( base );
+	bd_suma suma;
+	suma.estaciones = estaciones;
+	suma.sumas = Mem_assign_vector_zeros( hilos * estaciones ,
+										  sizeof( double ) );
+	suma.cantidades = Mem_assign_vector_zeros( hilos * estaciones ,
+											   sizeof( size_t ) );
+	BD_Recorrer_columna( base , variable , hilos ,
+						 BD_Sumar_valores , &suma );
+	
+	///Junto los parciales siempre en el mismo orden
+	unsigned int hilo;
+	long unsigned int pos;
+	for( hilo = 0 ; hilo < hilos ; hilo++ )
+		for( pos = 0 ; pos < estaciones ; pos++ )
+		{
+			
+			sumas[pos] += suma.sumas[hilo * estaciones + pos];
+			cantidades[pos] += suma.cantidades[hilo * estaciones + pos];
+			
+		}
+	
+	Mem_desassign( (void **)&suma.sumas );
+	Mem_desassign( (void **)&suma.cantidades );
+	
+}
+
+///Resumen de los datos (sin "--") de una variable
+typedef struct {
+	
+	size_t cantidad;
+	double media;
+	double m2; /// suma de los cuadrados de las diferencias a la media
+	float minimo;
+	float maximo;
+	
+} bd_estadistica;
+
+/**
+ * @brief Suma a 'total' el resumen de otra parte de los datos, con la
+ * fórmula de Chan para la media y la varianza: se puede juntar en
+ * cualquier agrupamiento sin perder precisión
+ */
+void BD_Juntar_estadisticas( bd_estadistica * total ,
+							 const bd_estadistica * parte )
+{
+	
+		if( parte->cantidad == 0 )
+			return;
+	
+	if( total->cantidad == 0 )
+	{
+		
+		*total = *parte;
+		return;
+		
+	}
+	
+	double n_total = total->cantidad;
+	double n_parte = parte->cantidad;
+	double n = n_total + n_parte;
+	double delta = parte->media - total->media;
+	total->media += delta * n_parte / n;
+	total->m2 += parte->m2 + delta * delta * n_total * n_parte / n;
+	total->cantidad += parte->cantidad;
+	if( parte->minimo < total->minimo )
+		total->minimo = parte->minimo;
+	if( parte->maximo > total->maximo )
+		total->maximo = parte->maximo;
+	
+}
+
+/**
+ * @brief Desvío estándar (poblacional) de un resumen
+ */
+double BD_Desvio( const bd_estadistica * e )
+{
+	
+	return e->cantidad == 0 ? 0 : sqrt( e->m2 / e->cantidad );
+	
+}
+
+///Parciales de las estadísticas, por hilo y estación
+typedef struct {
+	
+	long unsigned int estaciones;
+	bd_estadistica * partes; /// [hilo * estaciones + estación]
+	
+} bd_estadisticas;
+
+/**
+ * @brief Resume un tramo de valores en dos vueltas sobre el mismo
+ * bloque (ya en caché): la suma da la media del tramo y la segunda
+ * vuelta los desvíos a ella, el mínimo y el máximo
+ */
+void BD_Resumir_valores( void * contexto , unsigned int hilo ,
+						 long unsigned int estacion ,
+						 long unsigned int primera_fila ,
+						 const float * valores ,
+						 long unsigned int cantidad )
+{
+	
+	(void)primera_fila;
+	bd_estadisticas * e = contexto;
+	bd_estadistica tramo;
+	memset( &tramo , 0 , sizeof( tramo ) );
+	double suma = Simd_Sumar( valores , cantidad , &tramo.cantidad );
+		if( tramo.cantidad == 0 )
+			return;
+	
+	tramo.media = suma / tramo.cantidad;
+	tramo.minimo = INFINITY;
+	tramo.maximo = -INFINITY;
+	long unsigned int pos;
+	for( pos = 0 ; pos < cantidad ; pos++ )
+		if( !isnan( valores[pos] ) )
+		{
+			
+			double desvio = valores[pos] - tramo.media;
+			tramo.m2 += desvio * desvio;
+			if( valores[pos] < tramo.minimo )
+				tramo.minimo = valores[pos];
+			if( valores[pos] > tramo.maximo )
+				tramo.maximo = valores[pos];
+			
+		}
+	
+	long unsigned int parcial = hilo * e->estaciones + estacion;
+	BD_Juntar_estadisticas( &e->partes[parcial] , &tramo );
+	
+}
+
+/**
+ * @brief Estadísticas de una variable para cada estación, en una sola
+ * pasada por la columna repartida entre hilos; cada hilo resume sus
+ * bloques por separado y los parciales se juntan al final
+ *
+ * @param resultado : vector de cant_estaciones elementos
+ */
+void BD_Estadisticas_variable( bd * base , unsigned int variable ,
+							   bd_estadistica * resultado )
+{
+	
+	long unsigned int estaciones = base->cant_estaciones;
+	memset( resultado , 0 , estaciones * sizeof( bd_estadistica ) );
+		if( variable >= base->variables || estaciones == 0 )
+			return;
+	
+	unsigned int hilos = BD_Hilos( base );
+	bd_estadisticas e;
+	e.estaciones = estaciones;
+	e.partes = Mem_assign_vector_zeros( hilos * estaciones ,
+										sizeof( bd_estadistica ) );
+	BD_Recorrer_columna( base , variable , hilos ,
+						 BD_Resumir_valores , &e );
+	
+	///Junto los parciales siempre en el mismo orden
+	unsigned int hilo;
+	long unsigned int pos;
+	for( hilo = 0 ; hilo < hilos ; hilo++ )
+		for( pos = 0 ; pos < estaciones ; pos++ )
+			BD_Juntar_estadisticas( &resultado[pos] ,
+									&e.partes[hilo * estaciones +
+											  pos] );
+	
+	Mem_desassign( (void **)&e.partes );
+	
+}
+
+/**
+ * Cabecera y filas de una estación como texto, con '\n' en lugar de
+ * cada fin de fila. Se copian al iniciar, con el cerrojo de la base,
+ * leyendo el archivo y no el mapeo: el envío ya no usa la base y, si
+ * el archivo se acorta en su lugar, no toca páginas que no existen
+ */
+typedef struct {
+	
+	char * texto;
+	long unsigned int tam;
+	long unsigned int pos; /// siguiente byte a entregar
+	
+} bd_descarga;
+
+/**
+ * @brief Copia de los bytes [inicio , fin) a 'destino' (con lugar para
+ * un byte más) cambiando los fines de fila por '\n' y agregando uno si
+ * no termina en fin de fila
+ *
+ * @return bytes copiados o -1 si el archivo ya no los tiene
+ */
+long int BD_Descarga_copiar( bd * base , long unsigned int inicio ,
+							 long unsigned int fin , char * destino )
+{
+	
+	long unsigned int largo = fin - inicio;
+		if( File_map_read( base->archivo , inicio , destino , largo ) )
+			return -1;
+	
+	int sin_fin = largo > 0 && destino[largo - 1] != BD_FIN_DE_FILA;
+	char fin_de_fila[2] = { BD_FIN_DE_FILA , '\0' };
+	char * resto = destino;
+	const char * encontrado;
+	while( ( encontrado = Simd_Buscar( resto ,
+									   destino + largo - resto ,
+									   fin_de_fila ) ) != NULL )
+	{
+		
+		resto = (char *)encontrado;
+		*resto++ = '\n';
+		
+	}
+	if( sin_fin )
+		destino[largo++] = '\n';
+	
+	return largo;
+	
+}
+
+/**
+ * @param est : o NULL para copiar solo la cabecera
+ * @param a : área donde se copian los datos
+ * @return 0 o -1 si el archivo ya no tiene los datos cargados
+ */
+int BD_Descarga_iniciar( bd_descarga * d , bd * base , estacion * est ,
+						 arena * a )
+{
+	
+	unsigned int cant_tramos = est == NULL ? 0 : est->cant_tramos;
+	long unsigned int tam = base->inicio_datos + 1;
+	unsigned int pos;
+	for( pos = 0 ; pos < cant_tramos ; pos++ )
+		tam += est->tramos[pos].largo + 1;
+	d->texto = Mem_Arena_assign( a , tam );
+	d->tam = 0;
+	d->pos = 0;
+	
+	///La cabecera y luego cada tramo de la estación
+	long int copiado = BD_Descarga_copiar( base , 0 ,
+										   base->inicio_datos ,
+										   d->texto );
+	for( pos = 0 ; copiado >= 0 ; pos++ )
+	{
+		
+		d->tam += copiado;
+			if( pos == cant_tramos )
+				return 0;
+		tramo * t = &est->tramos[pos];
+		copiado = BD_Descarga_copiar( base , t->inicio ,
+									  t->inicio + t->largo ,
+									  &d->texto[d->tam] );
+		
+	}
+	
+	return -1;
+	
+}
+
+/**
+ * @brief Bytes que entregará el lector desde el principio
+ */
+long unsigned int BD_Descarga_tamanio( bd_descarga * d )
+{
+	
+	return d->tam;
+	
+}
+
+/**
+ * @brief Copia en 'buffer' lo siguiente del lector (es una
+ * sockets_fuente)
+ *
+ * @return bytes copiados, menos de 'maximo' solo al terminar
+ */
+unsigned int BD_Leer_descarga( void * contexto , char * buffer ,
+							   unsigned int maximo )
+{
+	
+	bd_descarga * d = contexto;
+	long unsigned int cant = d->tam - d->pos;
+	if( cant > maximo )
+		cant = maximo;
+	memcpy( buffer , &d->texto[d->pos] , cant );
+	d->pos += cant;
+	
+	return cant;
+	
+}
+
+#endif
@@ -0,0 +1,484 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>		/* rand , qsort */
+#include <math.h>
+#include <time.h>		/* timegm */
+#include <unistd.h>		/* unlink */
+
+#include "Instantanea.h"
+
+#define RUTA "BD_test.CSV"
+#define ESTACIONES 3
+#define VARIABLES 6
+///Filas del archivo inicial y de cada agregado
+#define FILAS 160000
+#define AGREGADAS 20000
+#define AGREGADOS 3
+#define TOTAL ( FILAS + AGREGADAS * AGREGADOS )
+#define RANGOS 40
+
+char * numeros[ESTACIONES] = { "30057" , "30061" , "30135" };
+char * nombres[ESTACIONES] = { "Ciudad Universitaria" , "La Cumbre" ,
+							   "Villa Carlos Paz" };
+
+///Lo que se escribió en el archivo, fila por fila
+unsigned char estaciones[TOTAL];
+int64_t tiempos[TOTAL];
+float valores[TOTAL][VARIABLES];
+
+///Filas visitadas por BD_Buscar_rango
+typedef struct {
+	
+	int64_t * tiempos;
+	float * valores;
+	long unsigned int cant;
+	
+} visitas;
+
+///Valor de una fila con fecha, para agrupar por fuerza bruta
+typedef struct {
+	
+	long int clave;
+	float valor;
+	
+} par;
+
+void Visitar( void * contexto , int64_t tiempo , float valor )
+{
+	
+	visitas * v = contexto;
+	v->tiempos[v->cant] = tiempo;
+	v->valores[v->cant] = valor;
+	v->cant++;
+	
+}
+
+int Comparar_pares( const void * a , const void * b )
+{
+	
+	long int x = ( (const par *)a )->clave;
+	long int y = ( (const par *)b )->clave;
+	
+	return ( x > y ) - ( x < y );
+	
+}
+
+int Cerca( double x , double y )
+{
+	
+	return fabs( x - y ) <= 1e-4 * ( 1 + fabs( y ) );
+	
+}
+
+int Iguales( float x , float y )
+{
+	
+	return x == y || ( isnan( x ) && isnan( y ) );
+	
+}
+
+/**
+ * @brief Escribe las filas [desde , hasta) al final del archivo y las
+ * anota: tramos de largo al azar, la estación 30061 desordenada, fechas
+ * que no existen y valores "--"
+ */
+void Escribir( FILE * archivo , long unsigned int desde ,
+			   long unsigned int hasta )
+{
+	
+	static int64_t relojes[ESTACIONES] = { 0 , 0 , 0 };
+	static unsigned int estacion = 0 , quedan = 0;
+	char fila[256];
+	long unsigned int pos;
+	for( pos = desde ; pos < hasta ; pos++ )
+	{
+		
+		if( quedan == 0 )
+		{
+			
+			estacion = rand() % ESTACIONES;
+			quedan = rand() % 300 + 1;
+			
+		}
+		quedan--;
+		
+		///Cada estación avanza 10 minutos por fila desde el 01/07/2016
+		relojes[estacion] += 600;
+		int64_t tiempo = 1467331200 + relojes[estacion];
+		if( estacion == 1 )
+			tiempo = 1467331200 + (int64_t)( rand() % 20000 ) * 600;
+		time_t t = tiempo;
+		struct tm civil;
+		gmtime_r( &t , &civil );
+		
+		unsigned int largo;
+		if( rand() % 100 == 0 )
+		{
+			
+			largo = sprintf( fila , "%s,%s,%u,31/02/2016 10:00" ,
+							 numeros[estacion] , nombres[estacion] ,
+							 estacion + 1 );
+			tiempo = BD_SIN_FECHA;
+			
+		}
+		else
+			largo = sprintf( fila , "%s,%s,%u,%02d/%02d/%04d "
+									"%02d:%02d" ,
+							 numeros[estacion] , nombres[estacion] ,
+							 estacion + 1 , civil.tm_mday ,
+							 civil.tm_mon + 1 , civil.tm_year + 1900 ,
+							 civil.tm_hour , civil.tm_min );
+		
+		unsigned int variable;
+		for( variable = 0 ; variable < VARIABLES ; variable++ )
+		{
+			
+			char * campo = &fila[largo + 1];
+			if( rand() % 30 == 0 )
+				largo += sprintf( &fila[largo] , ",--" );
+			else
+				largo += sprintf( &fila[largo] , ",%.1f" ,
+								  rand() % 4500 / 100.0 - 5 );
+			valores[pos][variable] = BD_Valor(
+									String_Vista_de_cadena( campo ) );
+			
+		}
+		fila[largo++] = BD_FIN_DE_FILA;
+		fwrite( fila , 1 , largo , archivo );
+		
+		estaciones[pos] = estacion;
+		tiempos[pos] = tiempo;
+		
+	}
+	
+}
+
+/**
+ * @brief Compara estadísticas y sumas de cada variable contra las
+ * calculadas por fuerza bruta sobre las primeras 'filas' filas
+ */
+unsigned int Comparar_columnas( bd * base , long unsigned int filas )
+{
+	
+	unsigned int errores = 0;
+	bd_estadistica resultado[ESTACIONES];
+	double sumas[ESTACIONES];
+	size_t cantidades[ESTACIONES];
+	unsigned int variable , e;
+	for( variable = 0 ; variable < VARIABLES ; variable++ )
+	{
+		
+		BD_Estadisticas_variable( base , variable , resultado );
+		BD_Sumar_variable( base , variable , sumas , cantidades );
+		for( e = 0 ; e < ESTACIONES ; e++ )
+		{
+			
+			long unsigned int pos;
+			long unsigned int est;
+			est = BD_Buscar_estacion( base , numeros[e] ) -
+				  base->estaciones;
+			size_t cantidad = 0;
+			double suma = 0 , m2 = 0;
+			float minimo = INFINITY , maximo = -INFINITY;
+			for( pos = 0 ; pos < filas ; pos++ )
+			{
+				
+				float valor = valores[pos][variable];
+				if( estaciones[pos] != e || isnan( valor ) )
+					continue;
+				cantidad++;
+				suma += valor;
+				if( valor < minimo )
+					minimo = valor;
+				if( valor > maximo )
+					maximo = valor;
+				
+			}
+			double media = cantidad == 0 ? 0 : suma / cantidad;
+			for( pos = 0 ; pos < filas ; pos++ )
+				if( estaciones[pos] == e &&
+					!isnan( valores[pos][variable] ) )
+					m2 += ( valores[pos][variable] - media ) *
+						  ( valores[pos][variable] - media );
+			
+			bd_estadistica * r = &resultado[est];
+			if( r->cantidad != cantidad ||
+				cantidades[est] != cantidad ||
+				!Cerca( r->media , media ) ||
+				!Cerca( sumas[est] , suma ) ||
+				!Cerca( BD_Desvio( r ) , sqrt( m2 / cantidad ) ) ||
+				r->minimo != minimo || r->maximo != maximo )
+			{
+				
+				printf( "\n Error: estadísticas de %s , variable %u" ,
+						numeros[e] , variable );
+				errores++;
+				
+			}
+			
+		}
+		
+	}
+	
+	return errores;
+	
+}
+
+/**
+ * @brief Compara búsquedas por fecha y agrupamientos de cada estación
+ * contra el recorrido por fuerza bruta de las primeras 'filas' filas
+ */
+unsigned int Comparar_fechas( bd * base , long unsigned int filas )
+{
+	
+	unsigned int errores = 0;
+	visitas v;
+	v.tiempos = Mem_assign_vector( filas , sizeof( int64_t ) );
+	v.valores = Mem_assign_vector( filas , sizeof( float ) );
+	par * pares = Mem_assign_vector( filas , sizeof( par ) );
+	unsigned int e;
+	for( e = 0 ; e < ESTACIONES ; e++ )
+	{
+		
+		estacion * est = BD_Buscar_estacion( base , numeros[e] );
+		long unsigned int pos;
+		
+		///Rangos al azar, el primero todo
+		unsigned int rango;
+		for( rango = 0 ; rango < RANGOS ; rango++ )
+		{
+			
+			unsigned int variable = rand() % VARIABLES;
+			int64_t desde = INT64_MIN , hasta = INT64_MAX;
+			if( rango > 0 )
+			{
+				
+				desde = 1467331200 + (int64_t)( rand() % 25000 ) * 600;
+				hasta = desde + (int64_t)( rand() % 3000 ) * 600;
+				
+			}
+			v.cant = 0;
+			BD_Buscar_rango( base , est , variable , desde , hasta ,
+							 Visitar , &v );
+			
+			long unsigned int visitada = 0;
+			for( pos = 0 ; pos < filas ; pos++ )
+			{
+				
+				if( estaciones[pos] != e ||
+					tiempos[pos] == BD_SIN_FECHA ||
+					tiempos[pos] < desde || tiempos[pos] > hasta )
+					continue;
+				if( visitada < v.cant &&
+					( v.tiempos[visitada] != tiempos[pos] ||
+					  !Iguales( v.valores[visitada] ,
+								valores[pos][variable] ) ) )
+					break;
+				visitada++;
+				
+			}
+			if( pos < filas || visitada != v.cant )
+			{
+				
+				printf( "\n Error: rango %u de %s" , rango ,
+						numeros[e] );
+				errores++;
+				
+			}
+			
+		}
+		
+		///Por hora, día y mes: mismas claves, filas, datos y sumas
+		bd_intervalo intervalo;
+		for( intervalo = BD_POR_HORA ; intervalo <= BD_POR_MES ;
+			 intervalo++ )
+		{
+			
+			unsigned int variable = rand() % VARIABLES;
+			long unsigned int cant = 0;
+			for( pos = 0 ; pos < filas ; pos++ )
+				if( estaciones[pos] == e &&
+					tiempos[pos] != BD_SIN_FECHA )
+				{
+					
+					long int clave = Fecha_Dia( tiempos[pos] );
+					if( intervalo == BD_POR_HORA )
+						clave = Fecha_Hora( tiempos[pos] );
+					else if( intervalo == BD_POR_MES )
+						clave = Fecha_Mes( clave );
+					pares[cant].clave = clave;
+					pares[cant].valor = valores[pos][variable];
+					cant++;
+					
+				}
+			qsort( pares , cant , sizeof( par ) , Comparar_pares );
+			
+			bd_grupos grupos;
+			BD_Agrupar( base , est , variable , intervalo , &grupos );
+			unsigned int g = 0;
+			pos = 0;
+			while( pos < cant && g < grupos.cant )
+			{
+				
+				grupo * actual = &grupos.g[g];
+				long unsigned int filas_grupo = 0 , datos = 0;
+				double suma = 0;
+				for( ; pos < cant && pares[pos].clave == actual->clave ;
+					 pos++ )
+				{
+					
+					filas_grupo++;
+					if( !isnan( pares[pos].valor ) )
+					{
+						
+						datos++;
+						suma += pares[pos].valor;
+						
+					}
+					
+				}
+				if( filas_grupo == 0 || actual->filas != filas_grupo ||
+					actual->datos != datos ||
+					!Cerca( actual->suma , suma ) )
+					break;
+				g++;
+				
+			}
+			if( pos < cant || g != grupos.cant )
+			{
+				
+				printf( "\n Error: grupos %u de %s" , intervalo ,
+						numeros[e] );
+				errores++;
+				
+			}
+			Mem_desassign( (void **)&grupos.g );
+			
+		}
+		
+	}
+	
+	Mem_desassign( (void **)&v.tiempos );
+	Mem_desassign( (void **)&v.valores );
+	Mem_desassign( (void **)&pares );
+	
+	return errores;
+	
+}
+
+unsigned int Comparar( bd * base , long unsigned int filas ,
+					   char * carga )
+{
+	
+	if( base == NULL || base->filas != filas ||
+		base->cant_estaciones != ESTACIONES ||
+		base->variables != VARIABLES )
+	{
+		
+		printf( "\n Error: %s , base incompleta" , carga );
+		return 1;
+		
+	}
+	
+	unsigned int errores = 0;
+	unsigned int e;
+	for( e = 0 ; e < ESTACIONES ; e++ )
+	{
+		
+		estacion * est = BD_Buscar_estacion( base , numeros[e] );
+		long unsigned int pos , cant = 0;
+		for( pos = 0 ; pos < filas ; pos++ )
+			cant += estaciones[pos] == e;
+		if( est == NULL || est->filas != cant ||
+			est->ordenado != ( e != 1 ) )
+		{
+			
+			printf( "\n Error: %s , estación %s" , carga , numeros[e] );
+			return errores + 1;
+			
+		}
+		
+	}
+	
+	errores += Comparar_columnas( base , filas );
+	errores += Comparar_fechas( base , filas );
+	printf( "\n %s: %lu filas , errores = %u" , carga , filas ,
+			errores );
+	
+	return errores;
+	
+}
+
+int main()
+{
+	
+	unsigned int errores = 0;
+	srand( 1 );
+	
+	FILE * archivo = fopen( RUTA , "wb" );
+	///La cabecera en latin-1, como la del archivo real
+	fprintf( archivo , "Base de datos meteorol\xf3gicos\r,,,\rNumero,"
+					   "Estaci\xf3n,Id Localidad,Fecha,Temperatura "
+					   "[\xba" "C],Humedad [%%HR],Punto de Roc\xedo "
+					   "[\xba" "C],Precipitaci\xf3n [mm],Velocidad "
+					   "Viento [Km/h],Presi\xf3n [hPa]\r" );
+	Escribir( archivo , 0 , FILAS );
+	fclose( archivo );
+	
+	///Del texto (guardando la instantánea) y de la instantánea
+	bd * texto = BD_Abrir( RUTA );
+	errores += Comparar( texto , FILAS , "texto" );
+	BD_Eliminar( &texto );
+	bd * base = BD_Cargar_instantanea( RUTA );
+	errores += Comparar( base , FILAS , "instantánea" );
+	
+	///Filas agregadas, una cortada a la mitad entre dos escrituras
+	if( base == NULL || BD_Seguir( base , RUTA ) < 0 )
+		errores++;
+	unsigned int agregado;
+	for( agregado = 0 ; base != NULL && agregado < AGREGADOS ;
+		 agregado++ )
+	{
+		
+		char * agregadas = NULL;
+		size_t largo = 0;
+		FILE * memoria = open_memstream( &agregadas , &largo );
+		long unsigned int desde = FILAS + agregado * AGREGADAS;
+		Escribir( memoria , desde , desde + AGREGADAS );
+		fclose( memoria );
+		
+		///Hasta la mitad de una fila: solo se cargan las completas
+		size_t corte = largo / 2;
+		long int completas = 0;
+		size_t pos;
+		for( pos = 0 ; pos < corte ; pos++ )
+			completas += agregadas[pos] == BD_FIN_DE_FILA;
+		archivo = fopen( RUTA , "ab" );
+		fwrite( agregadas , 1 , corte , archivo );
+		fflush( archivo );
+		if( BD_Actualizar( base ) != completas )
+			errores++;
+		fwrite( &agregadas[corte] , 1 , largo - corte , archivo );
+		fclose( archivo );
+		if( BD_Actualizar( base ) != AGREGADAS - completas )
+			errores++;
+		free( agregadas );
+		
+	}
+	errores += Comparar( base , TOTAL , "agregadas" );
+	BD_Eliminar( &base );
+	
+	texto = BD_Cargar( RUTA );
+	errores += Comparar( texto , TOTAL , "texto completo" );
+	BD_Eliminar( &texto );
+	
+	unlink( RUTA );
+	char * instantanea = BD_Ruta_instantanea_FREE( RUTA );
+	unlink( instantanea );
+	Mem_desassign( (void **)&instantanea );
+	
+	printf( "\n errores = %u\n" , errores );
+	
+	return errores != 0;
+	
+}
@@ -0,0 +1,823 @@
+/**
+ * @author Fernández Nicolás (nicofernandez@alumnos.unc.edu.ar)
+ * @date Mayo, 2017
+ * @version 0.5.2017 beta
+ *
+ * @brief Instantánea binaria de la base de datos: guarda la cabecera,
+ * las estaciones (con sus tramos, acumulados, índice de
+ * tiempos y resúmenes para percentiles) y las columnas ya
+ * separadas y comprimidas, para que al reiniciar el servidor no se
+ * vuelva a recorrer el texto del archivo mientras éste no cambie
+ * (mismo tamaño y fecha de modificación)
+ *
+ * \file Instantanea.h
+ */
+
+#ifndef INSTANTANEA_H
+#define INSTANTANEA_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "BD.h"
+
+#define BD_INSTANTANEA_EXTENSION ".bd"
+#define BD_INSTANTANEA_MAGIA "BDMETEO"
+///Aumentar con cada cambio del formato: las anteriores se descartan
+#define BD_INSTANTANEA_VERSION 5
+
+///Primer bloque del archivo; los demás se alinean a 8 bytes
+typedef struct {
+	
+	char magia[8];
+	uint32_t version;
+	uint32_t variables;
+	uint64_t tam; /// de la instantánea completa
+	uint64_t tam_archivo; /// del archivo de texto del que se armó
+	int64_t modificado; /// del archivo de texto, en segundos
+	int64_t modificado_ns;
+	uint64_t inicio_datos;
+	uint64_t procesado;
+	uint64_t filas;
+	uint64_t estaciones;
+	uint64_t partes_cabecera;
+	uint64_t tam_cabecera; /// nombres separados por '\0'
+	uint64_t cant_orden;
+	
+} bd_instantanea;
+
+typedef struct {
+	
+	uint64_t filas;
+	uint32_t campos;
+	uint32_t cant_tramos;
+	uint32_t cant_dias;
+	uint32_t cant_meses;
+	uint32_t largo_numero;
+	uint32_t largo_nombre;
+	uint32_t cant_segmentos;
+	uint32_t ordenado;
+	int64_t ultimo_tiempo;
+	
+} bd_instantanea_estacion;
+
+typedef struct {
+	
+	int64_t clave;
+	float acumulado;
+	uint32_t relleno;
+	
+} bd_instantanea_acumulado;
+
+///Resumen de cuantiles de una variable, seguido de sus centroides
+typedef struct {
+	
+	uint32_t cant;
+	uint32_t relleno;
+	double total;
+	double minimo;
+	double maximo;
+	
+} bd_instantanea_cuantiles;
+
+///Bloque comprimido de una columna, seguido de sus 'bytes' de datos
+typedef struct {
+	
+	uint32_t filas;
+	uint32_t bytes;
+	uint64_t presentes[COMPRESION_BLOQUE / 64];
+	
+} bd_instantanea_bloque;
+
+///Bloque comprimido de marcas de tiempo, seguido de sus datos
+typedef struct {
+	
+	uint32_t filas;
+	uint32_t bytes;
+	
+} bd_instantanea_bloque_tiempos;
+
+typedef struct {
+	
+	char * datos;
+	uint64_t tam;
+	uint64_t pos;
+	
+} bd_lector;
+
+/**
+ * @brief Ruta de la instantánea de un archivo de datos
+ */
+char * BD_Ruta_instantanea_FREE( char * ruta )
+{
+	
+	long unsigned int largo = strlen( ruta );
+	largo += strlen( BD_INSTANTANEA_EXTENSION );
+	char * instantanea = Mem_Create_string( largo );
+	strcpy( instantanea , ruta );
+	strcat( instantanea , BD_INSTANTANEA_EXTENSION );
+	
+	return instantanea;
+	
+}
+
+/**
+ * @brief Completa con ceros un bloque de 'tam' bytes hasta un múltiplo
+ * de 8
+ */
+void BD_Guardar_relleno( FILE * archivo , uint64_t tam )
+{
+	
+	static const char ceros[8] = { 0 };
+	if( tam % 8 != 0 )
+		fwrite( ceros , 1 , 8 - tam % 8 , archivo );
+	
+}
+
+/**
+ * @brief Escribe un bloque y lo completa con ceros hasta múltiplo de 8
+ */
+void BD_Guardar_bloque
+( FILE * archivo , const void * bloque , size_t tam )
+{
+	
+	if( tam > 0 )
+		fwrite( bloque , 1 , tam , archivo );
+	BD_Guardar_relleno( archivo , tam );
+	
+}
+
+void BD_Guardar_acumulados( acumulados * tabla , FILE * archivo )
+{
+	
+	unsigned int pos;
+	for( pos = 0 ; pos < tabla->cant ; pos++ )
+	{
+		
+		bd_instantanea_acumulado a;
+		a.clave = tabla->a[pos].clave;
+		a.acumulado = tabla->a[pos].acumulado;
+		a.relleno = 0;
+		BD_Guardar_bloque( archivo , &a , sizeof( a ) );
+		
+	}
+	
+}
+
+/**
+ * @brief Guarda los resúmenes de cuantiles de una estación, ya sin
+ * valores pendientes
+ */
+void BD_Guardar_cuantiles( bd * base , estacion * est , FILE * archivo )
+{
+	
+	unsigned int variable;
+	for( variable = 0 ; variable < base->variables ; variable++ )
+	{
+		
+		cuantiles * c = &est->distribuciones[variable];
+		Cuantiles_Comprimir( c );
+		bd_instantanea_cuantiles q;
+		memset( &q , 0 , sizeof( q ) );
+		q.cant = c->cant;
+		q.total = c->total;
+		q.minimo = c->minimo;
+		q.maximo = c->maximo;
+		BD_Guardar_bloque( archivo , &q , sizeof( q ) );
+		BD_Guardar_bloque( archivo ,
+						   c->centroides ,
+						   q.cant * sizeof( centroide ) );
+		
+	}
+	
+}
+
+/**
+ * @brief Guarda los bloques comprimidos de una columna y las filas del
+ * bloque incompleto
+ */
+void BD_Guardar_columna( bd * base , columna * c , FILE * archivo )
+{
+	
+	long unsigned int bloque;
+	for( bloque = 0 ; bloque < c->cant_bloques ; bloque++ )
+	{
+		
+		bd_instantanea_bloque b;
+		b.filas = c->bloques[bloque].filas;
+		b.bytes = c->bloques[bloque].bytes;
+		memcpy( b.presentes ,
+				c->bloques[bloque].presentes ,
+				sizeof( b.presentes ) );
+		BD_Guardar_bloque( archivo , &b , sizeof( b ) );
+		BD_Guardar_bloque( archivo ,
+						   c->bloques[bloque].datos ,
+						   b.bytes );
+		
+	}
+	BD_Guardar_bloque( archivo ,
+					   c->cola ,
+					   ( base->filas % COMPRESION_BLOQUE ) *
+					   sizeof( float ) );
+	
+}
+
+/**
+ * @brief Guarda los bloques comprimidos de las marcas de tiempo y las
+ * del bloque incompleto
+ */
+void BD_Guardar_tiempos( bd * base , FILE * archivo )
+{
+	
+	columna_tiempos * c = &base->tiempos;
+	long unsigned int bloque;
+	for( bloque = 0 ; bloque < c->cant_bloques ; bloque++ )
+	{
+		
+		bd_instantanea_bloque_tiempos b;
+		b.filas = c->bloques[bloque].filas;
+		b.bytes = c->bloques[bloque].bytes;
+		BD_Guardar_bloque( archivo , &b , sizeof( b ) );
+		BD_Guardar_bloque( archivo ,
+						   c->bloques[bloque].datos ,
+						   b.bytes );
+		
+	}
+	BD_Guardar_bloque( archivo ,
+					   c->cola ,
+					   ( base->filas % COMPRESION_BLOQUE ) *
+					   sizeof( int64_t ) );
+	
+}
+
+/**
+ * @brief Guarda la instantánea de la base; se escribe en un archivo
+ * temporal y se renombra, para no dejar nunca una a medio escribir
+ *
+ * @param ruta : archivo de datos del que se cargó la base
+ * @return 0 o -1 si no se pudo guardar
+ */
+int BD_Guardar_instantanea( bd * base , char * ruta )
+{
+	
+	struct stat info;
+		if( base == NULL || fstat( base->archivo->fd , &info ) < 0 )
+			return -1;
+	
+	char * destino = BD_Ruta_instantanea_FREE( ruta );
+	char * temporal = Mem_Create_string( strlen( destino ) + 1 );
+	strcpy( temporal , destino );
+	strcat( temporal , "~" );
+	
+	FILE * archivo = fopen( temporal , "wb" );
+		if( archivo == NULL )
+		{
+			
+			Mem_desassign( (void **)&temporal );
+			Mem_desassign( (void **)&destino );
+			return -1;
+			
+		}
+	
+	bd_instantanea cabecera;
+	memset( &cabecera , 0 , sizeof( cabecera ) );
+	memcpy( cabecera.magia , BD_INSTANTANEA_MAGIA , 8 );
+	cabecera.version = BD_INSTANTANEA_VERSION;
+	cabecera.variables = base->variables;
+	cabecera.tam_archivo = base->tam;
+	cabecera.modificado = info.st_mtim.tv_sec;
+	cabecera.modificado_ns = info.st_mtim.tv_nsec;
+	cabecera.inicio_datos = base->inicio_datos;
+	cabecera.procesado = base->procesado;
+	cabecera.filas = base->filas;
+	cabecera.estaciones = base->cant_estaciones;
+	cabecera.partes_cabecera = base->cabecera->parts;
+	cabecera.cant_orden = base->cant_orden;
+	unsigned int parte;
+	for( parte = 0 ; parte < base->cabecera->parts ; parte++ )
+		cabecera.tam_cabecera += strlen( base->cabecera->t[parte] ) + 1;
+	BD_Guardar_bloque( archivo , &cabecera , sizeof( cabecera ) );
+	
+	///Nombres de las columnas
+	for( parte = 0 ; parte < base->cabecera->parts ; parte++ )
+		fwrite( base->cabecera->t[parte] ,
+				1 ,
+				strlen( base->cabecera->t[parte] ) + 1 ,
+				archivo );
+	BD_Guardar_relleno( archivo , cabecera.tam_cabecera );
+	
+	///Estaciones
+	long unsigned int pos;
+	for( pos = 0 ; pos < base->cant_estaciones ; pos++ )
+	{
+		
+		estacion * est = &base->estaciones[pos];
+		bd_instantanea_estacion e;
+		memset( &e , 0 , sizeof( e ) );
+		e.filas = est->filas;
+		e.campos = est->campos;
+		e.cant_tramos = est->cant_tramos;
+		e.cant_dias = est->dias.cant;
+		e.cant_meses = est->meses.cant;
+		e.largo_numero = strlen( est->numero );
+		e.largo_nombre = strlen( est->nombre );
+		e.cant_segmentos = est->cant_segmentos;
+		e.ordenado = est->ordenado;
+		e.ultimo_tiempo = est->ultimo_tiempo;
+		BD_Guardar_bloque( archivo , &e , sizeof( e ) );
+		BD_Guardar_bloque( archivo , est->numero , e.largo_numero );
+		BD_Guardar_bloque( archivo , est->nombre , e.largo_nombre );
+		BD_Guardar_bloque( archivo ,
+						   est->tramos ,
+						   e.cant_tramos * sizeof( tramo ) );
+		BD_Guardar_bloque( archivo ,
+						   est->segmentos ,
+						   e.cant_segmentos * sizeof( segmento ) );
+		BD_Guardar_acumulados( &est->dias , archivo );
+		BD_Guardar_acumulados( &est->meses , archivo );
+		BD_Guardar_cuantiles( base , est , archivo );
+		
+	}
+	
+	///Marcas de tiempo, orden de los tramos y columnas
+	BD_Guardar_tiempos( base , archivo );
+	BD_Guardar_bloque( archivo ,
+					   base->orden ,
+					   base->cant_orden * sizeof( orden_tramo ) );
+	unsigned int variable;
+	for( variable = 0 ; variable < base->variables ; variable++ )
+		BD_Guardar_columna( base ,
+							&base->columnas[variable] ,
+							archivo );
+	
+	///Tamaño final para detectar instantáneas cortadas
+	cabecera.tam = ftell( archivo );
+	fseek( archivo , 0 , SEEK_SET );
+	fwrite( &cabecera , 1 , sizeof( cabecera ) , archivo );
+	
+	int error = ferror( archivo );
+	if( fclose( archivo ) != 0 )
+		error = 1;
+	if( !error && rename( temporal , destino ) < 0 )
+		error = 1;
+	if( error )
+		unlink( temporal );
+	
+	Mem_desassign( (void **)&temporal );
+	Mem_desassign( (void **)&destino );
+	
+	return error ? -1 : 0;
+	
+}
+
+/**
+ * @brief Siguiente bloque de la instantánea mapeada
+ *
+ * @return inicio del bloque o NULL si excede la instantánea
+ */
+void * BD_Leer_bloque( bd_lector * lector , uint64_t tam )
+{
+	
+	if( tam > lector->tam || lector->pos > lector->tam - tam )
+		return NULL;
+	
+	void * bloque = &lector->datos[lector->pos];
+	lector->pos += ( tam + 7 ) / 8 * 8;
+	
+	return bloque;
+	
+}
+
+/**
+ * @brief Copia un bloque de la instantánea en 'destino'
+ *
+ * @return 0 o -1 si excede la instantánea
+ */
+int BD_Leer_copia( bd_lector * lector , void * destino , uint64_t tam )
+{
+	
+	void * bloque = BD_Leer_bloque( lector , tam );
+		if( bloque == NULL )
+			return -1;
+	
+	if( tam > 0 )
+		memcpy( destino , bloque , tam );
+	
+	return 0;
+	
+}
+
+int BD_Leer_acumulados( bd_lector * lector , acumulados * tabla ,
+						unsigned int cant )
+{
+	
+	tabla->cant = cant;
+	tabla->asignados = cant;
+	tabla->a = Mem_assign_vector( cant , sizeof( acumulado ) );
+	
+	unsigned int pos;
+	for( pos = 0 ; pos < cant ; pos++ )
+	{
+		
+		bd_instantanea_acumulado * a;
+		a = BD_Leer_bloque( lector , sizeof( *a ) );
+			if( a == NULL )
+				return -1;
+		tabla->a[pos].clave = a->clave;
+		tabla->a[pos].acumulado = a->acumulado;
+		
+	}
+	
+	return 0;
+	
+}
+
+/**
+ * @brief Lee los resúmenes de cuantiles de una estación (ver
+ * BD_Guardar_cuantiles)
+ *
+ * @return 0 o -1 si la instantánea está incompleta o es inconsistente
+ */
+int BD_Leer_cuantiles( bd * base , bd_lector * lector , estacion * est )
+{
+	
+	est->distribuciones = Mem_assign_vector_zeros(
+											base->variables + 1 ,
+											sizeof( cuantiles ) );
+	unsigned int variable;
+	for( variable = 0 ; variable < base->variables ; variable++ )
+	{
+		
+		bd_instantanea_cuantiles * q;
+		q = BD_Leer_bloque( lector , sizeof( *q ) );
+			if( q == NULL || ( q->cant == 0 ) != ( q->total == 0 ) )
+				return -1;
+		
+		cuantiles * c = &est->distribuciones[variable];
+		c->total = q->total;
+		c->minimo = q->minimo;
+		c->maximo = q->maximo;
+		c->cant = q->cant;
+		c->centroides = Mem_assign_vector( q->cant ,
+										   sizeof( centroide ) );
+			if( BD_Leer_copia( lector ,
+							   c->centroides ,
+							   q->cant * sizeof( centroide ) ) )
+				return -1;
+		
+	}
+	
+	return 0;
+	
+}
+
+/**
+ * @brief Copia los datos de un bloque comprimido con el margen en cero
+ * que necesita Compresion.h
+ */
+unsigned char * BD_Copiar_comprimido( unsigned char * datos ,
+									  uint32_t bytes )
+{
+	
+	unsigned char * copia = Mem_assign( bytes + COMPRESION_MARGEN );
+	memcpy( copia , datos , bytes );
+	memset( &copia[bytes] , 0 , COMPRESION_MARGEN );
+	
+	return copia;
+	
+}
+
+/**
+ * @brief Copia los bloques comprimidos de las marcas de tiempo (ver
+ * BD_Guardar_tiempos)
+ *
+ * @return 0 o -1 si la instantánea está incompleta o es inconsistente
+ */
+int BD_Leer_tiempos( bd * base , bd_lector * lector )
+{
+	
+	columna_tiempos * c = &base->tiempos;
+	long unsigned int bloques = base->filas / COMPRESION_BLOQUE;
+	c->bloques = Mem_assign_vector_zeros( bloques + 1 ,
+										  sizeof( bloque_enteros ) );
+	c->bloques_asignados = bloques + 1;
+	
+	long unsigned int bloque;
+	for( bloque = 0 ; bloque < bloques ; bloque++ )
+	{
+		
+		bd_instantanea_bloque_tiempos * b;
+		b = BD_Leer_bloque( lector , sizeof( *b ) );
+			if( b == NULL || b->filas != COMPRESION_BLOQUE )
+				return -1;
+		unsigned char * datos = BD_Leer_bloque( lector , b->bytes );
+			if( datos == NULL )
+				return -1;
+		
+		bloque_enteros * destino = &c->bloques[c->cant_bloques++];
+		destino->filas = b->filas;
+		destino->bytes = b->bytes;
+		destino->datos = BD_Copiar_comprimido( datos , b->bytes );
+		
+	}
+	
+	return BD_Leer_copia( lector ,
+						  c->cola ,
+						  ( base->filas % COMPRESION_BLOQUE ) *
+						  sizeof( int64_t ) );
+	
+}
+
+/**
+ * @brief Copia los bloques comprimidos de una columna (ver
+ * BD_Guardar_columna)
+ *
+ * @return 0 o -1 si la instantánea está incompleta o es inconsistente
+ */
+int BD_Leer_columna( bd * base , bd_lector * lector , columna * c )
+{
+	
+	long unsigned int bloques = base->filas / COMPRESION_BLOQUE;
+	c->bloques = Mem_assign_vector_zeros( bloques + 1 ,
+										  sizeof( bloque_flotantes ) );
+	c->bloques_asignados = bloques + 1;
+	
+	long unsigned int bloque;
+	for( bloque = 0 ; bloque < bloques ; bloque++ )
+	{
+		
+		bd_instantanea_bloque * b;
+		b = BD_Leer_bloque( lector , sizeof( *b ) );
+			if( b == NULL || b->filas != COMPRESION_BLOQUE )
+				return -1;
+		
+		unsigned char * datos = BD_Leer_bloque( lector , b->bytes );
+			if( datos == NULL )
+				return -1;
+		
+		bloque_flotantes * destino = &c->bloques[c->cant_bloques++];
+		destino->filas = b->filas;
+		destino->bytes = b->bytes;
+		memcpy( destino->presentes ,
+				b->presentes ,
+				sizeof( b->presentes ) );
+		destino->datos = BD_Copiar_comprimido( datos , b->bytes );
+		
+	}
+	
+	return BD_Leer_copia( lector ,
+						  c->cola ,
+						  ( base->filas % COMPRESION_BLOQUE ) *
+						  sizeof( float ) );
+	
+}
+
+/**
+ * @brief Arma la base a partir de la instantánea, sin recorrer el texto
+ *
+ * @return 0 o -1 si la instantánea está incompleta o es inconsistente
+ */
+int BD_Leer_instantanea( bd * base , bd_lector * lector ,
+						 bd_instantanea * cabecera )
+{
+	
+	///Lo que después se usa como índice o posición en los datos
+	uint64_t partes = cabecera->partes_cabecera;
+	uint64_t variables = partes > BD_PRIMER_VARIABLE ?
+						 partes - BD_PRIMER_VARIABLE :
+						 0;
+		if( cabecera->variables != variables ||
+			cabecera->inicio_datos > cabecera->procesado ||
+			cabecera->procesado > cabecera->tam_archivo )
+			return -1;
+	
+	char * nombres = BD_Leer_bloque( lector , cabecera->tam_cabecera );
+		if( nombres == NULL || cabecera->tam_cabecera == 0 ||
+			nombres[cabecera->tam_cabecera - 1] != '\0' )
+			return -1;
+	base->cabecera = Mem_Create_text_null( cabecera->partes_cabecera );
+	uint64_t parte;
+	char * nombre = nombres;
+	for( parte = 0 ; parte < cabecera->partes_cabecera ; parte++ )
+	{
+		
+			if( nombre >= nombres + cabecera->tam_cabecera )
+				return -1;
+		base->cabecera->t[parte] = String_Crear( nombre );
+		nombre += strlen( nombre ) + 1;
+		
+	}
+	base->variables = cabecera->variables;
+	BD_Crear_columnas( base );
+	
+	base->estaciones = Mem_assign_vector_zeros(
+											cabecera->estaciones + 1 ,
+											sizeof( estacion ) );
+	base->estaciones_asignadas = cabecera->estaciones + 1;
+	uint64_t pos;
+	for( pos = 0 ; pos < cabecera->estaciones ; pos++ )
+	{
+		
+		bd_instantanea_estacion * e;
+		e = BD_Leer_bloque( lector , sizeof( *e ) );
+			if( e == NULL )
+				return -1;
+		
+		estacion * est = &base->estaciones[pos];
+		base->cant_estaciones++;
+		est->filas = e->filas;
+		est->campos = e->campos;
+		est->numero = Mem_Create_string( e->largo_numero );
+		est->nombre = Mem_Create_string( e->largo_nombre );
+		est->tramos = Mem_assign_vector( e->cant_tramos ,
+										 sizeof( tramo ) );
+		est->cant_tramos = e->cant_tramos;
+		est->tramos_asignados = e->cant_tramos;
+		est->segmentos = Mem_assign_vector( e->cant_segmentos ,
+											sizeof( segmento ) );
+		est->cant_segmentos = e->cant_segmentos;
+		est->segmentos_asignados = e->cant_segmentos;
+		est->ordenado = e->ordenado;
+		est->ultimo_tiempo = e->ultimo_tiempo;
+		if( BD_Leer_copia( lector , est->numero , e->largo_numero ) ||
+			BD_Leer_copia( lector , est->nombre , e->largo_nombre ) ||
+			BD_Leer_copia( lector ,
+						   est->tramos ,
+						   e->cant_tramos * sizeof( tramo ) ) ||
+			BD_Leer_copia( lector ,
+						   est->segmentos ,
+						   e->cant_segmentos * sizeof( segmento ) ) ||
+			BD_Leer_acumulados( lector , &est->dias , e->cant_dias ) ||
+			BD_Leer_acumulados( lector , &est->meses ,
+								e->cant_meses ) ||
+			BD_Leer_cuantiles( base , lector , est ) )
+			return -1;
+		
+		///Campos y tramos deben quedar dentro de lo cargado
+			if( est->campos > base->variables )
+				return -1;
+		unsigned int t;
+		for( t = 0 ; t < est->cant_tramos ; t++ )
+		{
+			
+			tramo * tr = &est->tramos[t];
+				if( tr->inicio < base->inicio_datos ||
+					tr->inicio > base->procesado ||
+					tr->largo > base->procesado - tr->inicio )
+					return -1;
+			
+		}
+		
+		///Cada segmento debe quedar dentro de un bloque existente
+		unsigned int seg;
+		for( seg = 0 ; seg < est->cant_segmentos ; seg++ )
+		{
+			
+			segmento * s = &est->segmentos[seg];
+				if( s->primera_fila + s->filas > cabecera->filas ||
+					s->primera_fila % COMPRESION_BLOQUE + s->filas >
+					COMPRESION_BLOQUE )
+					return -1;
+			
+		}
+		
+	}
+	
+	base->filas = cabecera->filas;
+		if( BD_Leer_tiempos( base , lector ) )
+			return -1;
+	
+	base->orden = Mem_assign_vector( cabecera->cant_orden + 1 ,
+									 sizeof( orden_tramo ) );
+	base->orden_asignados = cabecera->cant_orden + 1;
+	base->cant_orden = cabecera->cant_orden;
+	if( BD_Leer_copia( lector ,
+					   base->orden ,
+					   base->cant_orden * sizeof( orden_tramo ) ) )
+		return -1;
+	for( pos = 0 ; pos < base->cant_orden ; pos++ )
+		if( base->orden[pos].estacion >= base->cant_estaciones ||
+			base->orden[pos].tramo >=
+			base->estaciones[base->orden[pos].estacion].cant_tramos )
+			return -1;
+	
+	unsigned int variable;
+	for( variable = 0 ; variable < base->variables ; variable++ )
+		if( BD_Leer_columna( base ,
+							 lector ,
+							 &base->columnas[variable] ) )
+			return -1;
+	
+	return 0;
+	
+}
+
+/**
+ * @brief Indica si el archivo de datos es el mismo del que se armó la
+ * instantánea (tamaño y fecha de modificación)
+ */
+int BD_Instantanea_vigente( bd_instantanea * cabecera ,
+							file_map * archivo )
+{
+	
+	struct stat info;
+		if( archivo == NULL || fstat( archivo->fd , &info ) < 0 ||
+			info.st_size < 0 )
+			return 0;
+	
+	return (uint64_t)info.st_size == cabecera->tam_archivo &&
+		   info.st_mtim.tv_sec == cabecera->modificado &&
+		   info.st_mtim.tv_nsec == cabecera->modificado_ns;
+	
+}
+
+/**
+ * @brief Carga la base desde su instantánea si ésta corresponde al
+ * archivo de datos actual (mismo tamaño y fecha de modificación)
+ *
+ * @param ruta : archivo de datos
+ * @return base cargada o NULL si no hay una instantánea válida
+ */
+bd * BD_Cargar_instantanea( char * ruta )
+{
+	
+	char * ruta_instantanea = BD_Ruta_instantanea_FREE( ruta );
+	file_map * instantanea = File_map_open( ruta_instantanea );
+	Mem_desassign( (void **)&ruta_instantanea );
+		if( instantanea == NULL )
+			return NULL;
+	
+	bd_lector lector;
+	lector.datos = instantanea->data;
+	lector.tam = instantanea->size;
+	lector.pos = 0;
+	bd_instantanea * cabecera;
+	cabecera = BD_Leer_bloque( &lector , sizeof( bd_instantanea ) );
+	
+	file_map * archivo = NULL;
+	if( cabecera != NULL &&
+		memcmp( cabecera->magia , BD_INSTANTANEA_MAGIA , 8 ) == 0 &&
+		cabecera->version == BD_INSTANTANEA_VERSION &&
+		cabecera->tam == lector.tam )
+		archivo = File_map_open_reserved( ruta , BD_RESERVA );
+	
+	if( !BD_Instantanea_vigente( cabecera , archivo ) )
+	{
+		
+		File_map_close( &archivo );
+		File_map_close( &instantanea );
+		return NULL;
+		
+	}
+	
+	bd * base = Mem_assign( sizeof( bd ) );
+	memset( base , 0 , sizeof( bd ) );
+	base->archivo = archivo;
+	base->datos = archivo->data;
+	base->tam = archivo->size;
+	base->vigilancia = -1;
+	base->inicio_datos = cabecera->inicio_datos;
+	base->procesado = cabecera->procesado;
+	base->version = 1;
+	
+	int error = BD_Leer_instantanea( base , &lector , cabecera );
+	File_map_close( &instantanea );
+		if( error )
+		{
+			
+			fprintf( stderr , "\n ERROR: Instantánea de la base de "
+							  "datos inconsistente (%s)" , ruta );
+			BD_Eliminar( &base );
+			return NULL;
+			
+		}
+	BD_Firmar( base );
+	
+	return base;
+	
+}
+
+/**
+ * @brief Carga la base desde su instantánea o, si no la hay o quedó
+ * vieja, recorriendo el archivo de texto y guardando una nueva
+ *
+ * @param ruta : archivo de datos
+ * @return base cargada o NULL si no se pudo leer
+ */
+bd * BD_Abrir( char * ruta )
+{
+	
+	bd * base = BD_Cargar_instantanea( ruta );
+		if( base != NULL )
+			return base;
+	
+	base = BD_Cargar( ruta );
+	if( base != NULL && BD_Guardar_instantanea( base , ruta ) < 0 )
+		fprintf( stderr , "\n ERROR: No se pudo guardar la instantánea"
+						  " de la base de datos (%s)" , ruta );
+	
+	return base;
+	
+}
+
+#endif
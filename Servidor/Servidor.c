@@ -10,50 +10,213 @@
  * @file Servidor.c
  */
 
+#include <signal.h> //signal
+#include <stdint.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h> //setrlimit
+
 #include "../Recursos/File.h"
 #include "../Recursos/Sockets.h"
 #include "../Recursos/Error.h"
 #include "../Recursos/String.h"
+#include "../Recursos/Cache.h"
+#include "../Recursos/Cola.h"
+#include "../Recursos/Eventos.h"
+#include "BD.h"
+#include "Instantanea.h"
+
+///Base de datos cargada al iniciar el servidor: los comandos la leen
+///a la vez; actualizarla o recargarla espera a que terminen
+bd * base_de_datos = NULL;
+pthread_rwlock_t base_cerrojo = PTHREAD_RWLOCK_INITIALIZER;
+
+///Bytes de respuestas que se guardan para repetirlas sin calcularlas
+#define CACHE_PRESUPUESTO ( 64UL << 20 )
+cache respuestas;
+pthread_mutex_t respuestas_cerrojo = PTHREAD_MUTEX_INITIALIZER;
+
+///Todo lo que se calcula para un pedido se libera de una vez al enviar
+///la respuesta; cada hilo tiene su área
+#define PEDIDO_BLOQUE ( 64UL << 10 )
+__thread arena * pedido;
+
+///Hilos que calculan las respuestas
+#define CALCULO_HILOS 16
+///Hilos que envían descargas: cada una ocupa el suyo mientras espera
+///confirmaciones, sin demorar a los comandos que se calculan
+#define DESCARGA_HILOS 8
+///Comandos que esperan un hilo libre, en cada cola
+#define CALCULO_EN_ESPERA 1024
+
+typedef enum {
+	
+	SESION_PUERTO , /// espera el puerto UDP del cliente
+	SESION_CLAVE , /// espera la contraseña
+	SESION_COMANDO , /// espera un comando
+	SESION_CALCULO , /// un hilo de cálculo responde el comando
+	SESION_ENVIO , /// envía la respuesta
+	SESION_FIN /// (siguiente) se cierra al terminar de enviar
+	
+} sesion_estado;
+
+///Todo lo que ocupa una conexión: muchas inactivas cuestan poco
+typedef struct sesion {
+	
+	eventos_operacion op; /// la única pendiente de la conexión
+	sesion_estado estado;
+	sesion_estado siguiente; /// al terminar de enviar
+	int conexion;
+	struct sockaddr_in addrUDP;
+	char mensaje[TAM];
+	char * respuesta; /// propia, con el tamaño adelante
+	size_t largo;
+	size_t enviado;
+	struct sesion * calculada; /// en la lista de respuestas listas
+	struct sesion * detras; /// en la lista de las que esperan lugar
+	
+} sesion;
+
+///Sesiones cuyo comando espera un hilo de un grupo
+typedef struct {
+	
+	cola pendientes;
+	///Las que no entraron en la cola llena, en orden: no se les recibe
+	///nada más hasta que entre. Así el hilo que atiende las conexiones
+	///nunca espera lugar en la cola
+	sesion * en_espera;
+	sesion * en_espera_ultima;
+	
+} tareas;
+tareas calculos;
+tareas descargas;
+
+///Sesiones con su respuesta lista; 'aviso' (eventfd) despierta al
+///hilo que atiende las conexiones
+sesion * calculadas = NULL;
+pthread_mutex_t calculadas_cerrojo = PTHREAD_MUTEX_INITIALIZER;
+int aviso;
+
+///Con los descriptores agotados el que escucha sigue listo y aceptar
+///falla una y otra vez: se libera la reserva para aceptar al cliente
+///pendiente y cerrarlo. Sin reserva se deja de aceptar hasta que se
+///cierre una sesión
+int reserva = -1;
+long unsigned int cerradas = 0;
+
+///Respuesta a la contraseña correcta
+char * ayuda =
+	"Clave verificada con exito\n\n"
+	" · Comandos disponibles:\n\n"
+	"\t- listar: muestra un listado de todas las"
+	" estaciones que hay en la “base de datos”"
+	", y muestra de que censores tiene datos.\n"
+	"\t- descargar no_estación: descarga un arch"
+	"ivo con todos los datos de no_estación.\n"
+	"\t- diario_precipitacion no_estación: muest"
+	"ra el acumulado diario de la variable prec"
+	"ipitación de no_estación (no_día: acumnula"
+	"do mm).\n"
+	"\t- mensual_precipitacion no_estación: mues"
+	"tra el acumulado mensual de la variable pr"
+	"ecipitación (no_día: acumnulado mm).\n"
+	"\t- promedio variable: muestra el promedio "
+	"de todas las muestras de la variable de ca"
+	"da estación (no_estacion: promedio).\n"
+	"\t- estadisticas variable [no_estación]: m"
+	"uestra mínimo, máximo, media, desvío y ca"
+	"ntidad de datos de la variable por estaci"
+	"ón.\n"
+	"\t- percentil variable p [no_estación]: m"
+	"uestra el percentil p (de 0 a 100) aproxi"
+	"mado de la variable por estación.\n"
+	"\t- rango no_estación variable desde has"
+	"ta: muestra las muestras de la variable en"
+	"tre dos fechas (dd/mm/aaaa[ hh:mm]).\n"
+	"\t- resample no_estación variable interv"
+	"alo función: agrupa la variable por hora, "
+	"día o mes (hora|dia|mes) con suma, promed"
+	"io, mínimo o máximo (suma|promedio|min|ma"
+	"x).\n"
+	"\t- desconectar: termina la sesión del usua"
+	"rio.\n";
 
 /**
- * @brief Se pone a la espera de un cliente y en caso de uno acepta la
- * conexión y crea la conexión UDP para paso de archivos
+ * @brief Empieza la sesión de un cliente recién aceptado
  * 
- * @param servidor: file descriptor del socket que recibe conexiones TCP
  * @param conexion: file descriptor de la conexión con el cliente
- * @param conexion: file descriptor de la conexión UDP
- * @param addrUDP: para guardar los datos de dirección referidos al
- * cliente
- * @return 1 si falló, de lo contrario 0
+ * @param cli_addr: dirección del cliente
+ */
+void Cliente( eventos * , int , struct sockaddr_in * );
+
+/**
+ * @brief Con los descriptores agotados, acepta y cierra al cliente
+ * pendiente usando el descriptor de reserva
+ *
+ * @return 0 o -1 si no hay reserva
+ */
+int Rechazar_pendiente( int servidor );
+
+/**
+ * @brief Avanza la sesión según la operación que terminó: recibir el
+ * puerto UDP, la contraseña o un comando, o enviar una respuesta
+ */
+void Sesion_Avanzar( eventos * ev , sesion * s );
+
+/**
+ * @brief Pasa a la cola las sesiones en espera mientras haya lugar,
+ * sin esperarlo
  */
-int Cliente( int , int * , int * , struct sockaddr_in * );
+void Encolar_en_espera( tareas * t );
+
+/**
+ * @brief Indica si el mensaje es un comando 'descargar' con su
+ * argumento, sin normalizarlo
+ */
+int Es_descarga( char * mensaje );
+
+/**
+ * @brief Empieza a enviar las respuestas que calcularon los hilos; los
+ * que terminaron dejaron lugar en la cola para las sesiones en espera
+ */
+void Entregar_calculadas( eventos * ev );
+
+/**
+ * @brief Hilo de cálculo o de descargas: responde los comandos de la
+ * cola de sus tareas (el argumento) hasta que se cierra
+ */
+void * Trabajador( void * argumento );
 
 /**
  * @brief Interpreta el comando ingresado por el usuario
  *
- * @param comando : Cadena que contiene el comando a parsear y comparar
+ * @param comando : Cadena que contiene el comando a parsear y
+ * comparar, ya normalizada
  * @param sockfdUDP : socket de la conexion UDP en caso de transferencia
  * @param addrUDP : datos de la conexion UDP en caso de transferencia
  *
- * @return respuesta al comando recibido para enviar al cliente
+ * @return respuesta al comando recibido para enviar al cliente, en el
+ * área del pedido (vale hasta Mem_Arena_reset) o constante
  */
-char * Comando_FREE
+char * Comando
 ( char comando[] , int sockfdUDP , struct sockaddr_in addrUDP );
 
 /**
- * @brief Carga los nombres de las comlumnas de la bd en un vector
- * de cadenas
- *
- * @return Nombres y cantidad de columnas en un struct text
+ * @brief Comando con sus campos separados por un solo espacio, en el
+ * área del pedido
  */
-text * Cabecera_FREE( );
+char * Normalizar_comando( char * comando );
 
 /**
- * @brief Carga los nombres de las estaciones en un struct text
- *
- * @return Nombres y cantidad de estaciones en un struct text
+ * @brief Calcula la respuesta de un comando, sin pasar por la cache
  */
-text * Estaciones_FREE( );
+char * Ejecutar_comando
+( char comando[] , int sockfdUDP , struct sockaddr_in addrUDP );
+
+/**
+ * @brief Carga las filas agregadas al archivo desde el último comando
+ * o, si el archivo fue reemplazado, lo vuelve a cargar completo
+ */
+void Actualizar_base_de_datos( );
 
 int main( int argc , char **argv )
 {
@@ -65,702 +228,1318 @@ int main( int argc , char **argv )
 			   SI );
 	Error_int( Sockets_Imprimir_conexiones_disponibles( puerto ) , NO );
 	
-	char mensaje_enviar[TAM];
-	memset( mensaje_enviar , '\0' , TAM );
-	
-	while ( 1 )
+	///Un cliente que se va sin desconectar no termina el servidor
+	signal( SIGPIPE , SIG_IGN );
+	///Cada sesión ocupa un descriptor
+	struct rlimit descriptores;
+	getrlimit( RLIMIT_NOFILE , &descriptores );
+	descriptores.rlim_cur = descriptores.rlim_max;
+	setrlimit( RLIMIT_NOFILE , &descriptores );
+	
+	Cache_Iniciar( &respuestas , CACHE_PRESUPUESTO );
+	base_de_datos = BD_Abrir( BD_ARCHIVO );
+		if( base_de_datos == NULL )
+			fprintf( stderr , "\n ERROR: No se pudo cargar la base de "
+							  "datos (%s)" , BD_ARCHIVO );
+		else if( BD_Seguir( base_de_datos , BD_ARCHIVO ) < 0 )
+			fprintf( stderr , "\n ERROR: No se pueden seguir los cambio"
+							  "s de la base de datos (%s)" ,
+							  BD_ARCHIVO );
+	
+	///Un solo hilo atiende todas las conexiones sin bloquearse; los
+	///comandos los responden los hilos de cálculo
+	eventos ev;
+	Error_int( Eventos_Iniciar( &ev ) , SI );
+	aviso = eventfd( 0 , EFD_NONBLOCK | EFD_CLOEXEC );
+	Error_int( aviso , SI );
+	fcntl( servidor , F_SETFL ,
+		   fcntl( servidor , F_GETFL ) | O_NONBLOCK );
+	reserva = open( "/dev/null" , O_RDONLY | O_CLOEXEC );
+	Cola_Iniciar( &calculos.pendientes , CALCULO_EN_ESPERA ,
+				  sizeof( sesion * ) );
+	Cola_Iniciar( &descargas.pendientes , CALCULO_EN_ESPERA ,
+				  sizeof( sesion * ) );
+	pthread_t trabajadores[CALCULO_HILOS + DESCARGA_HILOS];
+	unsigned int hilos = 0;
+	while( hilos < CALCULO_HILOS &&
+		   pthread_create( &trabajadores[hilos] , NULL , Trabajador ,
+						   &calculos ) == 0 )
+		hilos++;
+	unsigned int calculo_hilos = hilos;
+	while( hilos < calculo_hilos + DESCARGA_HILOS &&
+		   pthread_create( &trabajadores[hilos] , NULL , Trabajador ,
+						   &descargas ) == 0 )
+		hilos++;
+	if( calculo_hilos == 0 || hilos == calculo_hilos )
 	{
 		
-		int conexion, sockfdUDP;
-		struct sockaddr_in addrUDP;
+		fprintf( stderr , "\n ERROR: No se pudieron crear los hilos de "
+						  "cálculo" );
+		return EXIT_FAILURE;
 		
-		while(Cliente( servidor , &conexion , &sockfdUDP , &addrUDP ));
-		
-		int contrasenia = 1;
-		Sockets_Enviar_mensaje_TCP( conexion , "Clave=" );
+	}
+	
+	struct sockaddr_in cli_addr;
+	eventos_operacion aceptar;
+	memset( &aceptar , 0 , sizeof( aceptar ) );
+	aceptar.tipo = EVENTOS_ACEPTAR;
+	aceptar.fd = servidor;
+	aceptar.buffer = &cli_addr;
+	aceptar.tam = sizeof( cli_addr );
+	Error_int( Eventos_Pedir( &ev , &aceptar ) , SI );
+	uint64_t avisos;
+	eventos_operacion despertar;
+	memset( &despertar , 0 , sizeof( despertar ) );
+	despertar.tipo = EVENTOS_LEER;
+	despertar.fd = aviso;
+	despertar.buffer = &avisos;
+	despertar.tam = sizeof( avisos );
+	Error_int( Eventos_Pedir( &ev , &despertar ) , SI );
+	printf( "\n Servidor disponible y a la espera de conexiones (%s)." ,
+			Eventos_Mecanismo( &ev ) );
+	fflush( stdout );
+	
+	///Sin aceptar desde que hubo 'cerradas_al_pausar' sesiones cerradas
+	int pausado = 0;
+	long unsigned int cerradas_al_pausar = 0;
+	while ( 1 )
+	{
 		
-		char mensaje_leer[TAM];
-		do
-		{
-			
-			int error = Sockets_Leer_mensaje_TCP( conexion ,
-												  mensaje_leer ,
-												  TAM );
-			if( Error_int( error , NO ) )
-				break;
-			
-			if( contrasenia )
+		eventos_operacion * terminadas[EVENTOS_LOTE];
+		unsigned int cant = Eventos_Esperar( &ev , terminadas ,
+											 EVENTOS_LOTE );
+		unsigned int pos;
+		for( pos = 0 ; pos < cant ; pos++ )
+			if( terminadas[pos] == &aceptar )
 			{
 				
-				contrasenia = 0;
-				if( strcmp( mensaje_leer , "root" ) == 0 )
+				long int resultado = aceptar.resultado;
+				if( resultado >= 0 )
+					Cliente( &ev , resultado , &cli_addr );
+				else if( ( resultado == -EMFILE ||
+						   resultado == -ENFILE ) &&
+						 Rechazar_pendiente( servidor ) < 0 )
 				{
 					
-					strcpy( mensaje_enviar ,
-						   "Clave verificada con exito\n\n"
-						   " · Comandos disponibles:\n\n"
-						   "\t- listar: muestra un listado de todas las"
-						   " estaciones que hay en la “base de datos”"
-						   ", y muestra de que censores tiene datos.\n"
-						   "\t- descargar no_estación: descarga un arch"
-						   "ivo con todos los datos de no_estación.\n"
-						   "\t- diario_precipitacion no_estación: muest"
-						   "ra el acumulado diario de la variable prec"
-						   "ipitación de no_estación (no_día: acumnula"
-						   "do mm).\n"
-						   "\t- mensual_precipitacion no_estación: mues"
-						   "tra el acumulado mensual de la variable pr"
-						   "ecipitación (no_día: acumnulado mm).\n"
-						   "\t- promedio variable: muestra el promedio "
-						   "de todas las muestras de la variable de ca"
-						   "da estación (no_estacion: promedio).\n"
-						   "\t- desconectar: termina la sesión del usua"
-						   "rio.\n" );
+					pausado = 1;
+					cerradas_al_pausar = cerradas;
+					continue;
 					
 				}
-				else
-				{
-					
-					strcpy( mensaje_enviar , "Clave incorrecta" );
-					strcpy( mensaje_leer , "desconectar" );
-					
-				}
-			
+				Eventos_Pedir( &ev , &aceptar );
+				
 			}
-			else
+			else if( terminadas[pos] == &despertar )
 			{
 				
-				char * cmd_re;
-				cmd_re = Comando_FREE( mensaje_leer ,
-									   sockfdUDP ,
-									   addrUDP );
-				strcpy( mensaje_enviar , cmd_re );
-				Mem_desassign( (void **)&cmd_re );
+				Entregar_calculadas( &ev );
+				Eventos_Pedir( &ev , &despertar );
 				
 			}
+			else
+				Sesion_Avanzar( &ev , terminadas[pos]->dato );
+		
+		if( pausado && cerradas != cerradas_al_pausar )
+		{
 			
-			error = Sockets_Enviar_mensaje_largo_TCP( conexion ,
-													  mensaje_enviar );
-			if( Error_int( error , NO ) )
-				break;
+			pausado = 0;
+			Eventos_Pedir( &ev , &aceptar );
 			
-		} while( strcmp( mensaje_leer , "desconectar" ) != 0 );
-		
-		shutdown( conexion , 2 );
+		}
 		
 	}
 	
+	Cola_Cerrar( &calculos.pendientes );
+	Cola_Cerrar( &descargas.pendientes );
+	unsigned int hilo;
+	for( hilo = 0 ; hilo < hilos ; hilo++ )
+		pthread_join( trabajadores[hilo] , NULL );
+	Cola_Liberar( &calculos.pendientes );
+	Cola_Liberar( &descargas.pendientes );
+	Eventos_Cerrar( &ev );
+	close( aviso );
+	if( reserva >= 0 )
+		close( reserva );
 	close( servidor );
+	Cache_Vaciar( &respuestas );
+	BD_Eliminar( &base_de_datos );
 	
 	return EXIT_SUCCESS;
 	
 }
 
-int Cliente( servidor , conexion , sockfdUDP , addrUDP )
-int servidor ;
-int * conexion ;
-int * sockfdUDP ;
-struct sockaddr_in * addrUDP ;
+///Cierra la conexión y libera la sesión
+void Sesion_Cerrar( sesion * s )
+{
+	
+	close( s->conexion );
+	Mem_desassign( (void **)&s->respuesta );
+	Mem_desassign( (void **)&s );
+	cerradas++;
+	
+}
+
+int Rechazar_pendiente( int servidor )
+{
+	
+		if( reserva < 0 )
+			return -1;
+	
+	close( reserva );
+	int pendiente = accept( servidor , NULL , NULL );
+	if( pendiente >= 0 )
+		close( pendiente );
+	reserva = open( "/dev/null" , O_RDONLY | O_CLOEXEC );
+	
+	return 0;
+	
+}
+
+///Espera un mensaje del cliente, que se interpreta según 'estado'
+void Sesion_Recibir( eventos * ev , sesion * s , sesion_estado estado )
+{
+	
+	s->estado = estado;
+	s->op.tipo = EVENTOS_RECIBIR;
+	s->op.buffer = s->mensaje;
+	s->op.tam = TAM - 1;
+	if( Eventos_Pedir( ev , &s->op ) < 0 )
+		Sesion_Cerrar( s );
+	
+}
+
+///Envía lo que falta de la respuesta
+void Sesion_Seguir_enviando( eventos * ev , sesion * s )
+{
+	
+	s->estado = SESION_ENVIO;
+	s->op.tipo = EVENTOS_ENVIAR;
+	s->op.buffer = s->respuesta + s->enviado;
+	s->op.tam = s->largo - s->enviado;
+	if( Eventos_Pedir( ev , &s->op ) < 0 )
+		Sesion_Cerrar( s );
+	
+}
+
+/**
+ * @brief Envía un mensaje largo (ver Sockets_Enviar_mensaje_largo_TCP)
+ * y luego pasa a 'siguiente'
+ */
+void Sesion_Responder( eventos * ev , sesion * s , char * mensaje ,
+					   sesion_estado siguiente )
+{
+	
+	s->respuesta = Sockets_Mensaje_largo_FREE( mensaje , &s->largo );
+	s->enviado = 0;
+	s->siguiente = siguiente;
+	Sesion_Seguir_enviando( ev , s );
+	
+}
+
+void Cliente( ev , conexion , cli_addr )
+eventos * ev ;
+int conexion ;
+struct sockaddr_in * cli_addr ;
 {
 	
-	///Acepto un cliente:
 	struct direccion dir;
-	struct sockaddr_in cli_addr;
-	printf("\n Servidor disponible y a la espera de una conexión.");
+	Sockets_Direccion_del_sockaddr_in( *cli_addr , &dir );
+	printf( "\n Conectado a: %s:%d " , dir.ip , dir.puerto );
 	fflush( stdout );
-	if( Error_int( Sockets_Aceptar_un_cliente( conexion ,
-											   servidor ,
-											   cli_addr ,
-											  &dir ) ,
-				   NO ) )
+	
+	sesion * s = Mem_assign( sizeof( sesion ) );
+	memset( s , 0 , sizeof( sesion ) );
+	s->conexion = conexion;
+	s->op.fd = conexion;
+	s->op.dato = s;
+	///Los datos van por UDP a la misma dirección, en el puerto que
+	///indique el cliente
+	s->addrUDP = *cli_addr;
+	Sesion_Recibir( ev , s , SESION_PUERTO );
+	
+}
+
+void Sesion_Avanzar( eventos * ev , sesion * s )
+{
+	
+	///Error o el cliente cerró la conexión
+	long int resultado = s->op.resultado;
+	if( resultado < 0 ||
+		( resultado == 0 && s->estado != SESION_ENVIO ) )
 	{
 		
-		close( *conexion );
-		return 1;
+		Sesion_Cerrar( s );
+		return;
 		
 	}
-	printf( "\n Conectado a: %s:%d " , dir.ip , dir.puerto );
-	struct direccion mi_dir;
-	Sockets_Direccion_del_socket( *conexion , &mi_dir );
-	printf( "\n Desde: %s:%d " , mi_dir.ip , mi_dir.puerto );
-	///Recibo el puerto del socket UDP:
-	char msj_leer[TAM];
-	Error_int( Sockets_Leer_mensaje_TCP( *conexion , msj_leer , TAM ) ,
-			   SI );
-	char puerto_UDP_str[ strlen(msj_leer) ];
-	strcpy( puerto_UDP_str , msj_leer );
-	int puerto_UDP = atoi	( puerto_UDP_str );
-	///Conecto por UDP:
-	struct hostent * servidorUDP = Sockets_Verificar_host_IPv4(dir.ip);
-	if( Error_pnt( servidorUDP , NO ) )
+	
+	if( s->estado == SESION_ENVIO )
 	{
 		
-		close( *conexion );
-		return 1;
+		s->enviado += resultado;
+			if( s->enviado < s->largo )
+			{
+				
+				Sesion_Seguir_enviando( ev , s );
+				return;
+				
+			}
+		Mem_desassign( (void **)&s->respuesta );
+		if( s->siguiente == SESION_FIN )
+			Sesion_Cerrar( s );
+		else
+			Sesion_Recibir( ev , s , s->siguiente );
+		return;
 		
 	}
-	*sockfdUDP = Sockets_Crear_Y_Conectar_Socket_INET_UDP( servidorUDP ,
-														   addrUDP ,
-														   puerto_UDP );
-	if( Error_int( *sockfdUDP , NO ) )
+	
+	s->mensaje[resultado] = '\0';
+	switch( s->estado )
 	{
 		
-		close( *conexion );
-		return 1;
+		case SESION_PUERTO:
+		{
+			
+			s->addrUDP.sin_port = htons( atoi( s->mensaje ) );
+			struct direccion dir;
+			Sockets_Direccion_del_sockaddr_in( s->addrUDP , &dir );
+			printf( "\n UDP: %s:%d " , dir.ip , dir.puerto );
+			fflush( stdout );
+			s->respuesta = String_Crear( "Clave=" );
+			s->largo = strlen( s->respuesta );
+			s->enviado = 0;
+			s->siguiente = SESION_CLAVE;
+			Sesion_Seguir_enviando( ev , s );
+			break;
+			
+		}
+		
+		case SESION_CLAVE:
+			if( strcmp( s->mensaje , "root" ) == 0 )
+				Sesion_Responder( ev , s , ayuda , SESION_COMANDO );
+			else
+				Sesion_Responder( ev , s , "Clave incorrecta" ,
+								  SESION_FIN );
+			break;
+		
+		default:
+		{
+			
+			tareas * t = Es_descarga( s->mensaje ) ? &descargas :
+													 &calculos;
+			s->estado = SESION_CALCULO;
+			s->detras = NULL;
+			if( t->en_espera == NULL )
+				t->en_espera = s;
+			else
+				t->en_espera_ultima->detras = s;
+			t->en_espera_ultima = s;
+			Encolar_en_espera( t );
+			
+		}
 		
 	}
-	Sockets_Direccion_del_sockaddr_in( *addrUDP , &dir );
-	printf( "\n UDP: %s:%d " , dir.ip , dir.puerto );
-	fflush( stdout );
-	
-	return 0;
 	
 }
 
-unsigned int Cantidad_de_simbolos( char * cadena )
+int Es_descarga( char * mensaje )
 {
 	
-	unsigned int cantidad = 0;
+	vista resto = String_Vista_de_cadena( mensaje );
+	vista campo;
+	unsigned int campos = 0;
+	while( campos < 2 &&
+		   String_Siguiente_campo( &resto , " " , &campo ) )
+		if( campo.largo > 0 )
+		{
+			
+				if( campos == 0 &&
+					!String_Vista_igual_cadena( campo , "descargar" ) )
+					return 0;
+			campos++;
+			
+		}
+	
+	return campos == 2;
 	
-	int pos;
-	for( pos = 0 ; pos < strlen( cadena ) ; pos++ )
+}
+
+void Encolar_en_espera( tareas * t )
+{
+	
+	while( t->en_espera != NULL )
 	{
 		
-		if( cadena[pos] < 0 )
-			cantidad++;
+		int puesto = Cola_Intentar_poner( &t->pendientes ,
+										  &t->en_espera );
+			if( puesto == 0 )
+				return;
+		sesion * s = t->en_espera;
+		t->en_espera = s->detras;
+		///Cerrada, ningún hilo la va a responder
+		if( puesto < 0 )
+			Sesion_Cerrar( s );
 		
 	}
 	
-	return cantidad;
-	
 }
 
-char * Corregir_simbolos_FREE( char * cadena )
+void Entregar_calculadas( eventos * ev )
 {
 	
-	int correcciones = Cantidad_de_simbolos( cadena );
+	Encolar_en_espera( &calculos );
+	Encolar_en_espera( &descargas );
+	pthread_mutex_lock( &calculadas_cerrojo );
+	sesion * s = calculadas;
+	calculadas = NULL;
+	pthread_mutex_unlock( &calculadas_cerrojo );
+	
+	while( s != NULL )
+	{
+		
+		sesion * proxima = s->calculada;
+		Sesion_Seguir_enviando( ev , s );
+		s = proxima;
+		
+	}
+	
+}
+
+/**
+ * @brief Responde el comando de la sesión; la respuesta queda en la
+ * sesión, lista para enviar
+ */
+void Calcular( sesion * s )
+{
 	
-	char * cadena_corregida;
-	cadena_corregida = Mem_Create_string( strlen( cadena )
-										  + correcciones );
+	Actualizar_base_de_datos( );
+	char * comando = Normalizar_comando( s->mensaje );
+	///El socket UDP solo hace falta para descargar
+	int sockfdUDP = -1;
+	int descarga = strncmp( comando , "descargar " , 10 ) == 0;
+	if( descarga )
+		sockfdUDP = socket( AF_INET , SOCK_DGRAM , 0 );
+	
+	///La respuesta queda en el área del pedido: se copia sin retener
+	///la base. La descarga la retiene solo mientras prepara el envío
+	if( !descarga )
+		pthread_rwlock_rdlock( &base_cerrojo );
+	char * respuesta = Comando( comando , sockfdUDP , s->addrUDP );
+	if( !descarga )
+		pthread_rwlock_unlock( &base_cerrojo );
+	s->respuesta = Sockets_Mensaje_largo_FREE( respuesta , &s->largo );
+	s->enviado = 0;
+	s->siguiente = strcmp( comando , "desconectar" ) == 0 ?
+				   SESION_FIN :
+				   SESION_COMANDO;
+	Mem_Arena_reset( pedido );
+	if( sockfdUDP >= 0 )
+		close( sockfdUDP );
 	
-	correcciones = 0;
+}
+
+void * Trabajador( void * argumento )
+{
 	
-	int pos;
-	for( pos = 0 ; pos < strlen(cadena) ; pos++ )
+	tareas * t = argumento;
+	pedido = Mem_Arena_create( PEDIDO_BLOQUE );
+	sesion * s;
+	while( Cola_Sacar( &t->pendientes , &s ) )
 	{
 		
-		if( cadena[pos] < 0 )
-			correcciones++;
-		
-		switch( cadena[pos] )
-		{
-			
-			case -70:
-				strcat( cadena_corregida , "º" );
-				break;
-			case -13:
-				strcat( cadena_corregida , "ó" );
-				break;
-			case -19:
-				strcat( cadena_corregida , "í" );
-				break;
-			case 13:
-				cadena_corregida[pos + correcciones] = '\n';
-				break;
-			default:
-				cadena_corregida[pos + correcciones] = cadena[pos];
-			
-		}
+		Calcular( s );
+		pthread_mutex_lock( &calculadas_cerrojo );
+		s->calculada = calculadas;
+		calculadas = s;
+		pthread_mutex_unlock( &calculadas_cerrojo );
+		uint64_t uno = 1;
+		if( write( aviso , &uno , sizeof( uno ) ) < 0 )
+			perror( " " );
 		
 	}
+	Mem_Arena_delete( &pedido );
 	
-	return cadena_corregida;
+	return NULL;
 	
 }
 
-text * Cabecera_FREE( )
+void Actualizar_base_de_datos( )
 {
 	
-	FILE * bd = fopen( "datos_meteorologicos.CSV" , "r" );
-		if( bd == NULL ){
-			return NULL;
-		}
+	///Sin cambios alcanza con leer: no se espera a los demás pedidos
+	pthread_rwlock_rdlock( &base_cerrojo );
+	int cambiado = BD_Cambiado( base_de_datos );
+	pthread_rwlock_unlock( &base_cerrojo );
+		if( !cambiado )
+			return;
 	
-	///Asigno memoria al vector de cadenas
-	File_move_to_next_ocurrence_char( bd , 13 , 1 );
-	File_move_to_next_ocurrence_char( bd , 13 , 1 );
-	char * linea3 = File_read_until_next_ocurrence_char_FREE( bd , 13 );
-	char * linea3_mem = linea3;
-	linea3 = Corregir_simbolos_FREE( linea3 );
-	Mem_desassign( (void **)&linea3_mem );
-	linea3_mem = linea3;
-	unsigned int cantidad_de_columnas;
-	cantidad_de_columnas = String_Cantidad_de_columnas( linea3 , "," );
-	text * cabecera;
-	cabecera = Mem_Create_text_null( cantidad_de_columnas );
-	
-	unsigned int pos_cab;
-	for( pos_cab = 0 ; pos_cab < cabecera->parts ; pos_cab++ )
+	pthread_rwlock_wrlock( &base_cerrojo );
+	if( BD_Actualizar( base_de_datos ) >= 0 )
 	{
 		
-		char * str = String_Cortar_hasta_FREE( &linea3 , "," );
-		cabecera->t[pos_cab] = Mem_Create_string( strlen( str ) );
-		strcpy( cabecera->t[pos_cab] , str );
+		pthread_rwlock_unlock( &base_cerrojo );
+		return;
 		
 	}
 	
-	Mem_desassign( (void **)&linea3_mem );
-	fclose( bd );
-	
-	return cabecera;
+	///La versión vuelve a empezar: nada de lo guardado sirve
+	pthread_mutex_lock( &respuestas_cerrojo );
+	Cache_Vaciar( &respuestas );
+	pthread_mutex_unlock( &respuestas_cerrojo );
+	BD_Eliminar( &base_de_datos );
+	base_de_datos = BD_Abrir( BD_ARCHIVO );
+	if( base_de_datos == NULL )
+		fprintf( stderr , "\n ERROR: No se pudo cargar la base de "
+						  "datos (%s)" , BD_ARCHIVO );
+	else
+		BD_Seguir( base_de_datos , BD_ARCHIVO );
+	pthread_rwlock_unlock( &base_cerrojo );
 	
 }
 
-unsigned int Cantidad_de_estaciones()
+char * Listar( )
 {
 	
-	FILE * bd = fopen( "datos_meteorologicos.CSV" , "r" );
-		if( bd == NULL ){
-			return 0;
-		}
-	
-	unsigned int cantidad = 0;
-	
-	///Cargo la linea 4 (primera con datos)
-	File_move_to_next_ocurrence_char( bd , 13 , /*add =*/ 1 );
-	File_move_to_next_ocurrence_char( bd , 13 , /*add =*/ 1 );
-	File_move_to_next_ocurrence_char( bd , 13 , /*add =*/ 1 );
-	char * linea;
-	char * linea_cortada;
-	linea = File_read_until_next_ocurrence_char_FREE( bd , 13 );
-	linea_cortada = linea;
-	char ultimo_nro_estacion[10];
-	memset( ultimo_nro_estacion , '\0' , 10 );
-	char * nro_estacion;
-	///Proceso la linea y cargo la siguiente hasta llegar al final
-	int tam_bd = File_size( bd );
-	while( ftell( bd ) != tam_bd )
+	if( base_de_datos == NULL )
+		return "Base de datos perdida.";
+	
+	///Cada estación y, debajo, las variables de las que tiene datos
+	char ** cabecera = base_de_datos->cabecera->t;
+	cadena_creciente lista;
+	String_Creciente_Iniciar_en( &lista ,
+								 64 * base_de_datos->cant_estaciones ,
+								 pedido );
+	long unsigned int pos;
+	for( pos = 0 ; pos < base_de_datos->cant_estaciones ; pos++ )
 	{
 		
-		nro_estacion = String_Cortar_hasta_FREE( &linea_cortada , "," );
-		if( strcmp( ultimo_nro_estacion , nro_estacion ) != 0 )
+		estacion * est = &base_de_datos->estaciones[pos];
+		String_Agregar( &lista , est->numero );
+		String_Agregar_caracter( &lista , ' ' );
+		String_Agregar( &lista , est->nombre );
+		String_Agregar_caracter( &lista , '\n' );
+		unsigned int campo;
+		for( campo = 0 ; campo < est->campos ; campo++ )
 		{
 			
-			cantidad++;
-			strcpy( ultimo_nro_estacion , nro_estacion );
+			String_Agregar_caracter( &lista , '\t' );
+			String_Agregar( &lista ,
+							cabecera[BD_PRIMER_VARIABLE + campo] );
+			String_Agregar_caracter( &lista , '\n' );
 			
 		}
-		Mem_desassign( (void **)&nro_estacion );
-		Mem_desassign( (void **)&linea );
-		linea = File_read_until_next_ocurrence_char_FREE( bd , 13 );
-		linea_cortada = linea;
 		
 	}
 	
-	Mem_desassign( (void **)&linea );
+	return lista.texto;
+	
+}
+
+/**
+ * @brief Envía la cabecera y las filas de la estación, sin pasar por
+ * un archivo. Toma el cerrojo de la base solo para copiarlas al área
+ * del pedido: el envío, que espera confirmaciones, no demora a quien
+ * actualiza la base
+ */
+char * Descargar
+( char * nro_estacion , int sockfdUDP , struct sockaddr_in addrUDP )
+{
+	
+	bd_descarga descarga;
+	pthread_rwlock_rdlock( &base_cerrojo );
+	int copiada = -1;
+	if( base_de_datos != NULL )
+		copiada = BD_Descarga_iniciar( &descarga ,
+									   base_de_datos ,
+									   BD_Buscar_estacion(
+										   base_de_datos ,
+										   nro_estacion ) ,
+									   pedido );
+	pthread_rwlock_unlock( &base_cerrojo );
+		if( copiada < 0 )
+			return "Base de datos perdida";
 	
-	fclose( bd );
+	///Envio los datos
+	int error = Sockets_Enviar_datos_por_UDP( sockfdUDP ,
+											  addrUDP ,
+											  BD_Descarga_tamanio(
+												  &descarga ) ,
+											  BD_Leer_descarga ,
+											  &descarga ,
+											  nro_estacion ,
+											  SI );
+	if( Error_int( error , NO ) )
+		return "No existen datos de la estación solicitada";
 	
-	return cantidad;
+	return "Envío de datos realizado";
 	
 }
 
-text * Estaciones_FREE( )
+char * Precipitacion( char * nro_estacion , char caso )
 {
 	
-	unsigned int cant_estaciones = Cantidad_de_estaciones();
+	if( base_de_datos == NULL )
+		return "Base de datos perdida";
 	
-	FILE * bd = fopen( "datos_meteorologicos.CSV" , "r" );
-		if( bd == NULL )
+	///Los acumulados se calculan al cargar la base
+	estacion * est = BD_Buscar_estacion( base_de_datos , nro_estacion );
+	acumulados * tabla;
+	char * cabecera;
+	char * separador;
+	switch( caso )
+	{
+		
+		case 'd':
+			tabla = est == NULL ? NULL : &est->dias;
+			cabecera = "\tDia\t\tAcumulado[mm]\n\n";
+			separador = "\t";
+			break;
+		
+		case 'm':
+			tabla = est == NULL ? NULL : &est->meses;
+			cabecera = "\tMes\t\tAcumulado[mm]\n\n";
+			separador = "\t\t";
+			break;
+		
+		default:
 			return NULL;
+		
+	}
+	
+	///Cada fila se agrega al final de la respuesta
+	unsigned int cant = tabla == NULL ? 0 : tabla->cant;
+	cadena_creciente respuesta;
+	String_Creciente_Iniciar_en( &respuesta ,
+								 strlen( cabecera ) + cant * 24 ,
+								 pedido );
+	String_Agregar( &respuesta , cabecera );
 	
-	text * estaciones;
-	estaciones = Mem_Create_text_null( cant_estaciones );
-	
-	///Cargo la linea 4 (primera con datos)
-	File_move_to_next_ocurrence_char( bd , 13 , /*add =*/ 1 );
-	File_move_to_next_ocurrence_char( bd , 13 , /*add =*/ 1 );
-	File_move_to_next_ocurrence_char( bd , 13 , /*add =*/ 1 );
-	char * linea;
-	char * linea_cortada;
-	linea = File_read_until_next_ocurrence_char_FREE( bd , 13 );
-	linea_cortada = linea;
-	char ultimo_nro_estacion[10];
-	memset( ultimo_nro_estacion , '\0' , 10 );
-	char * nro_estacion;
-	unsigned int pos = 0;
-	///Proceso la linea y cargo la siguiente hasta llegar al final
-	int tam_bd = File_size( bd );
-	while( ftell( bd ) != tam_bd )
+	unsigned int pos;
+	for( pos = 0 ; pos < cant ; pos++ )
 	{
 		
-		nro_estacion = String_Cortar_hasta_FREE( &linea_cortada , "," );
-		if( strcmp( ultimo_nro_estacion , nro_estacion ) != 0 )
-		{
-			
-			strcpy( ultimo_nro_estacion , nro_estacion );
-			///Cargo numero, nombre y cantidad separado por '|'
-			char * nombre = String_Cortar_hasta_FREE( &linea_cortada ,
-													  "," );
-			String_Mover_hasta( &linea_cortada , "," , /*add =*/ 1 );
-			String_Mover_hasta( &linea_cortada , "," , /*add =*/ 1 );
-			int campos = 0;
-			char * campo;
-			while( linea_cortada != NULL )
-			{
-				
-				campo = String_Cortar_hasta_FREE(&linea_cortada , ",");
-				if( strcmp( campo , "--" ) != 0 )
-					campos++;
-				Mem_desassign( (void **)&campo );
-				
-			}
-			Mem_desassign( (void **)&linea );
-			char * estacion = (char *)Mem_assign( strlen(nro_estacion)
-												  + strlen(nombre)
-												  + 5 );
-			sprintf( estacion ,
-					"%s|%s|%i" ,
-					 nro_estacion ,
-					 nombre ,
-					 campos );
-			Mem_desassign( (void **)&nro_estacion );
-			Mem_desassign( (void **)&nombre );
-			estaciones->t[pos] = estacion;
-			
-			pos++;
-			
-		}
-		
-		linea = File_read_until_next_ocurrence_char_FREE( bd , 13 );
-		linea_cortada = linea;
+		acumulado * a = &tabla->a[pos];
+		String_Agregar_caracter( &respuesta , '\t' );
+		if( caso == 'd' )
+			Fecha_Agregar_dia( &respuesta , a->clave );
+		else
+			Fecha_Agregar_mes( &respuesta , a->clave );
+		String_Agregar( &respuesta , separador );
+		String_Agregar_flotante( &respuesta , a->acumulado );
+		String_Agregar_caracter( &respuesta , '\n' );
 		
 	}
 	
-	Mem_desassign( (void **)&linea );
+	return respuesta.texto;
 	
-	fclose( bd );
+}
+
+char * Promedio( char * nombre_variable )
+{
 	
-	return estaciones;
+	if( base_de_datos == NULL )
+		return "Base de datos perdida";
+	
+	int variable;
+	variable = BD_Buscar_variable( base_de_datos , nombre_variable );
+		if( variable < 0 )
+			return "No existe la variable solicitada";
+	
+	long unsigned int estaciones = base_de_datos->cant_estaciones;
+	double * sumas;
+	sumas = Mem_Arena_assign( pedido , ( estaciones + 1 ) *
+									   sizeof( double ) );
+	size_t * cantidades;
+	cantidades = Mem_Arena_assign( pedido , ( estaciones + 1 ) *
+											sizeof( size_t ) );
+	BD_Sumar_variable( base_de_datos , variable , sumas , cantidades );
+	
+	char * nombre;
+	nombre = base_de_datos->cabecera->t[BD_PRIMER_VARIABLE + variable];
+	cadena_creciente respuesta;
+	String_Creciente_Iniciar_en( &respuesta , 64 + 32 * estaciones ,
+								 pedido );
+	String_Agregar( &respuesta , "\tEstación: promedio " );
+	String_Agregar( &respuesta , nombre );
+	String_Agregar( &respuesta , "\n\n" );
+	
+	long unsigned int pos;
+	for( pos = 0 ; pos < estaciones ; pos++ )
+	{
+		
+		String_Agregar_caracter( &respuesta , '\t' );
+		String_Agregar( &respuesta ,
+						base_de_datos->estaciones[pos].numero );
+		String_Agregar( &respuesta , ": " );
+		if( cantidades[pos] == 0 )
+			String_Agregar( &respuesta , "--" );
+		else
+			String_Agregar_flotante( &respuesta , sumas[pos] /
+												  cantidades[pos] );
+		String_Agregar_caracter( &respuesta , '\n' );
+		
+	}
+	
+	return respuesta.texto;
 	
 }
 
-char * Listar_FREE( )
+/**
+ * @brief Agrega una fila de estadísticas: cantidad, mínimo, máximo,
+ * media y desvío separados por tabulaciones
+ */
+void Estadisticas_Agregar_fila( cadena_creciente * respuesta ,
+								char * etiqueta , bd_estadistica * e )
 {
 	
-	text * cabecera;
-	cabecera = Cabecera_FREE( );
-		if( cabecera == NULL )
-			return String_Crear( "Base de datos perdida." );
+	String_Agregar_caracter( respuesta , '\t' );
+	String_Agregar( respuesta , etiqueta );
+	String_Agregar_caracter( respuesta , '\t' );
+	String_Agregar_entero( respuesta , e->cantidad );
+	if( e->cantidad == 0 )
+		String_Agregar( respuesta , "\t--\t--\t--\t--" );
+	else
+	{
+		
+		String_Agregar_caracter( respuesta , '\t' );
+		String_Agregar_flotante( respuesta , e->minimo );
+		String_Agregar_caracter( respuesta , '\t' );
+		String_Agregar_flotante( respuesta , e->maximo );
+		String_Agregar_caracter( respuesta , '\t' );
+		String_Agregar_flotante( respuesta , e->media );
+		String_Agregar_caracter( respuesta , '\t' );
+		String_Agregar_flotante( respuesta , BD_Desvio( e ) );
+		
+	}
+	String_Agregar_caracter( respuesta , '\n' );
+	
+}
+
+char * Estadisticas( char * argumento )
+{
 	
-	text * estaciones;
-	estaciones = Estaciones_FREE( );
-		if( estaciones == NULL )
-			return String_Crear( "Base de datos perdida." );
+	if( base_de_datos == NULL )
+		return "Base de datos perdida";
 	
-	///Asigno memoria a la lista
-	unsigned int estacion;
-	unsigned int tam_lista = 0;
-	for( estacion = 0 ; estacion < estaciones->parts ; estacion++ )
+	///Si no es una variable, el último campo es la estación
+	estacion * est = NULL;
+	int variable = BD_Buscar_variable( base_de_datos , argumento );
+	char * separador = strrchr( argumento , ' ' );
+	if( variable < 0 && separador != NULL )
 	{
 		
-		char * puntero = estaciones->t[estacion];
-		String_Mover_hasta( &puntero , "|" , /*add =*/ 1 );
-		String_Mover_hasta( &puntero , "|" , /*add =*/ 1 );
-		int campos;
-		sscanf( puntero , "%i" , &campos );
-		tam_lista += 2 + campos;
+		vista antes = String_Vista( argumento , separador - argumento );
+		char * nombre_variable;
+		nombre_variable = String_Vista_copiar_en( pedido , antes );
+		variable = BD_Buscar_variable( base_de_datos ,
+									   nombre_variable );
+		est = BD_Buscar_estacion( base_de_datos , separador + 1 );
+			if( variable >= 0 && est == NULL )
+				return "No existe la estación "
+					   "solicitada";
 		
 	}
-	text * lista = Mem_Create_text_null( tam_lista );
 	
-	///Cargo la lista
-	unsigned int pos_lista = 0;
-	for( estacion = 0 ; estacion < estaciones->parts ; estacion++ )
+		if( variable < 0 )
+			return "No existe la variable solicitada";
+	
+	long unsigned int estaciones = base_de_datos->cant_estaciones;
+	bd_estadistica * resultado;
+	resultado = Mem_Arena_assign( pedido , ( estaciones + 1 ) *
+										   sizeof( bd_estadistica ) );
+	BD_Estadisticas_variable( base_de_datos , variable , resultado );
+	
+	char * nombre;
+	nombre = base_de_datos->cabecera->t[BD_PRIMER_VARIABLE + variable];
+	cadena_creciente respuesta;
+	String_Creciente_Iniciar_en( &respuesta , 128 + 64 * estaciones ,
+								 pedido );
+	String_Agregar( &respuesta , "\tEstadísticas " );
+	String_Agregar( &respuesta , nombre );
+	String_Agregar( &respuesta , "\n\n\tEstación\tDatos\tMínimo\tMáxim"
+								 "o\tMedia\tDesvío\n" );
+	
+	long unsigned int pos;
+	if( est != NULL )
+	{
+		
+		pos = est - base_de_datos->estaciones;
+		Estadisticas_Agregar_fila( &respuesta , est->numero ,
+								   &resultado[pos] );
+		
+	}
+	else
 	{
 		
-		char * puntero = estaciones->t[estacion];
-		char * str = String_Cortar_hasta_FREE(&puntero , "|");
-		lista->t[pos_lista] = Mem_Create_string( strlen( str ) + 1 );
-		strcpy( lista->t[pos_lista] , str );
-		strcat( lista->t[pos_lista] , " " );
-		Mem_desassign( (void *)&str );
-		
-		pos_lista++;
-		str = String_Cortar_hasta_FREE(&puntero , "|");
-		lista->t[pos_lista] = Mem_Create_string( strlen( str ) + 1 );
-		strcpy( lista->t[pos_lista] , str );
-		strcat( lista->t[pos_lista] , "\n" );
-		Mem_desassign( (void *)&str );
-		
-		pos_lista++;
-		int campos;
-		sscanf( puntero , "%i" , &campos );
-		unsigned int nro_campo;
-		for( nro_campo = 0 ; nro_campo < campos ; nro_campo++ )
+		bd_estadistica total;
+		memset( &total , 0 , sizeof( total ) );
+		for( pos = 0 ; pos < estaciones ; pos++ )
 		{
 			
-			unsigned int tam = strlen( cabecera->t[nro_campo + 4] ) + 2;
-			lista->t[pos_lista] = Mem_Create_string( tam );
-			lista->t[pos_lista][0] = '\t';
-			lista->t[pos_lista][1] = '\0';
-			strcat( lista->t[pos_lista] , cabecera->t[nro_campo + 4] );
-			strcat( lista->t[pos_lista] , "\n" );
-			pos_lista++;
+			estacion * actual = &base_de_datos->estaciones[pos];
+			Estadisticas_Agregar_fila( &respuesta , actual->numero ,
+									   &resultado[pos] );
+			BD_Juntar_estadisticas( &total , &resultado[pos] );
 			
 		}
+		Estadisticas_Agregar_fila( &respuesta , "Total" , &total );
 		
 	}
 	
-	Mem_Delete_text( &cabecera );
-	Mem_Delete_text( &estaciones );
+	return respuesta.texto;
 	
-	///Asigno memoria al retorno
-	unsigned int tam_retorno = 0;
-	for( pos_lista = 0 ; pos_lista < tam_lista ; pos_lista++ )
-		tam_retorno += strlen( lista->t[pos_lista] );
-	char * retorno = Mem_Create_string( tam_retorno );
+}
+
+///Máximo de campos de los argumentos de un comando
+#define COMANDO_CAMPOS 32
+
+/**
+ * @brief Separa los argumentos de un comando en campos, sin los vacíos
+ * de espacios repetidos
+ *
+ * @param campos : vector de COMANDO_CAMPOS vistas
+ * @return cantidad de campos
+ */
+unsigned int Separar_campos( char * argumento , vista * campos )
+{
 	
-	///Cargo el retorno
-	for( pos_lista = 0 ; pos_lista < tam_lista ; pos_lista++ )
-		strcat( retorno , lista->t[pos_lista] );
+	unsigned int cant = 0;
+	vista resto = String_Vista_de_cadena( argumento );
+	vista campo;
+	while( cant < COMANDO_CAMPOS &&
+		   String_Siguiente_campo( &resto , " " , &campo ) )
+		if( campo.largo > 0 )
+			campos[cant++] = campo;
 	
-	Mem_Delete_text( &lista );
+	return cant;
 	
-	return retorno;
+}
+
+/**
+ * @brief Variable nombrada por los campos [primero , ultimo]
+ *
+ * @return número de variable o -1 si no existe
+ */
+int Buscar_variable_en_campos( vista * campos , unsigned int primero ,
+							   unsigned int ultimo )
+{
+	
+	vista nombre = String_Vista( campos[primero].inicio ,
+								 campos[ultimo].inicio +
+								 campos[ultimo].largo -
+								 campos[primero].inicio );
+	char * copia = String_Vista_copiar_en( pedido , nombre );
+	int variable = BD_Buscar_variable( base_de_datos , copia );
+	
+	return variable;
 	
 }
 
-///@bug "ERROR: No se puede leer el mensaje. (UDP)" --> (Igual funciona)
-char * Descargar
-( char * nro_estacion , int sockfdUDP , struct sockaddr_in addrUDP )
+/**
+ * @brief Agrega el cuantil 'q' de un resumen ("--" si está vacío) y
+ * un fin de línea
+ */
+void Percentil_Agregar( cadena_creciente * respuesta , cuantiles * c ,
+						double q )
 {
 	
-	FILE * archivo = fopen( nro_estacion , "w" );
-		if( archivo == NULL )
-			return "Intente mas tarde";
+	if( c->total == 0 )
+		String_Agregar( respuesta , "--" );
+	else
+		String_Agregar_flotante( respuesta ,
+								 Cuantiles_Cuantil( c , q ) );
+	String_Agregar_caracter( respuesta , '\n' );
 	
-	FILE * bd = fopen( "datos_meteorologicos.CSV" , "r" );
-		if( bd == NULL )
+}
+
+char * Percentil( char * argumento )
+{
+	
+	if( base_de_datos == NULL )
+		return "Base de datos perdida";
+	
+	///Si lo anterior a p no es una variable, el último campo es la
+	///estación y p el anteúltimo
+	vista campos[COMANDO_CAMPOS];
+	unsigned int cant = Separar_campos( argumento , campos );
+	estacion * est = NULL;
+	int variable = -1;
+	float p;
+	int hay_p = cant >= 2 &&
+				String_Vista_a_flotante( campos[cant - 1] , &p );
+	if( hay_p )
+		variable = Buscar_variable_en_campos( campos , 0 , cant - 2 );
+	float p_estacion;
+	if( variable < 0 && cant >= 3 &&
+		String_Vista_a_flotante( campos[cant - 2] , &p_estacion ) )
+	{
+		
+		variable = Buscar_variable_en_campos( campos , 0 , cant - 3 );
+		if( variable >= 0 )
 		{
 			
-			fclose(archivo);
-			return "Base de datos perdida";
+			char * numero;
+			numero = String_Vista_copiar_en( pedido ,
+											 campos[cant - 1] );
+			est = BD_Buscar_estacion( base_de_datos , numero );
+				if( est == NULL )
+					return "No existe la estación solicitada";
+			p = p_estacion;
+			hay_p = 1;
 			
 		}
+		
+	}
+		if( hay_p && variable < 0 )
+			return "No existe la variable solicitada";
+		if( !hay_p || !( p >= 0 && p <= 100 ) )
+			return "Uso: percentil variable p "
+				   "[no_estación], p de 0 a 100";
+	
+	char * nombre;
+	nombre = base_de_datos->cabecera->t[BD_PRIMER_VARIABLE + variable];
+	long unsigned int estaciones = base_de_datos->cant_estaciones;
+	cadena_creciente respuesta;
+	String_Creciente_Iniciar_en( &respuesta , 128 + 32 * estaciones ,
+								 pedido );
+	String_Agregar( &respuesta , "\tEstación: percentil " );
+	String_Agregar_flotante( &respuesta , p );
+	String_Agregar_caracter( &respuesta , ' ' );
+	String_Agregar( &respuesta , nombre );
+	String_Agregar( &respuesta , "\n\n" );
+	
+	///Cada estación tiene su resumen; el total los junta
+	cuantiles total;
+	memset( &total , 0 , sizeof( total ) );
+	long unsigned int pos;
+	for( pos = 0 ; pos < estaciones ; pos++ )
+	{
+		
+		estacion * actual = &base_de_datos->estaciones[pos];
+			if( est != NULL && actual != est )
+				continue;
+		cuantiles * c = &actual->distribuciones[variable];
+		String_Agregar_caracter( &respuesta , '\t' );
+		String_Agregar( &respuesta , actual->numero );
+		String_Agregar( &respuesta , ": " );
+		Percentil_Agregar( &respuesta , c , p / 100 );
+		if( est == NULL )
+			Cuantiles_Juntar( &total , c );
+		
+	}
+	if( est == NULL )
+	{
+		
+		String_Agregar( &respuesta , "\tTotal: " );
+		Percentil_Agregar( &respuesta , &total , p / 100 );
+		Cuantiles_Liberar( &total );
+		
+	}
+	
+	return respuesta.texto;
+	
+}
+
+///Respuesta de 'rango', que crece con cada fila encontrada
+typedef struct {
+	
+	cadena_creciente texto;
+	double suma;
+	long unsigned int datos; /// filas con valor
+	
+} rango_respuesta;
+
+void Rango_Agregar_fila( void * contexto , int64_t tiempo ,
+						 float valor )
+{
 	
-	///Cargo el archivo
-	char * linea = File_read_until_next_ocurrence_char_FREE( bd , 13 );
-	fprintf( archivo , "%s\n" , linea );
-	Mem_desassign( (void **)&linea );
-	linea = File_read_until_next_ocurrence_char_FREE( bd , 13 );
-	fprintf( archivo , "%s\n" , linea );
-	Mem_desassign( (void **)&linea );
-	linea = File_read_until_next_ocurrence_char_FREE( bd , 13 );
-	fprintf( archivo , "%s\n" , linea );
-	Mem_desassign( (void **)&linea );
-	int tam_bd = File_size( bd );
-	while( ftell( bd ) != tam_bd )
+	rango_respuesta * r = contexto;
+	String_Agregar_caracter( &r->texto , '\t' );
+	Fecha_Agregar_tiempo( &r->texto , tiempo );
+	String_Agregar_caracter( &r->texto , '\t' );
+	if( isnan( valor ) )
+		String_Agregar( &r->texto , "--" );
+	else
 	{
 		
-		linea = File_read_until_next_ocurrence_char_FREE( bd , 13 );
-		char * linea_sin_cortar = linea;
-		char * nro_estacion_linea = String_Cortar_hasta_FREE( &linea ,
-															  "," );
-		if( strcmp( nro_estacion , nro_estacion_linea ) == 0 )
-			fprintf( archivo , "%s\n" , linea_sin_cortar );
-		Mem_desassign( (void **)&linea_sin_cortar );
-		Mem_desassign( (void **)&nro_estacion_linea );
+		String_Agregar_flotante( &r->texto , valor );
+		r->suma += valor;
+		r->datos++;
 		
 	}
+	String_Agregar_caracter( &r->texto , '\n' );
 	
-	///Envio el archivo
-	if( Error_int( Sockets_Enviar_archivo_por_UDP( sockfdUDP ,
-												   addrUDP ,
-												   nro_estacion ,
-												   SI ) ,
-				   NO ) )
-		return "No existen datos de la estación solicitada";
+}
+
+/**
+ * @brief Lee una fecha de los últimos campos: "dd/mm/aaaa hh:mm" (dos
+ * campos) o "dd/mm/aaaa", que como fin del rango abarca el día entero
+ *
+ * @param cant : campos sin leer; se le restan los usados
+ * @param fin : 1 si la fecha es el fin del rango
+ * @return 1 o 0 si no es una fecha válida
+ */
+int Rango_Leer_fecha( vista * campos , unsigned int * cant , int fin ,
+					  int64_t * tiempo )
+{
 	
-	return "Envío de datos realizado";
+		if( *cant == 0 )
+			return 0;
+	
+	vista ultimo = campos[*cant - 1];
+	if( memchr( ultimo.inicio , ':' , ultimo.largo ) != NULL )
+	{
+		
+			if( *cant < 2 )
+				return 0;
+		vista dia = campos[*cant - 2];
+		vista fecha = String_Vista( dia.inicio ,
+									ultimo.inicio + ultimo.largo -
+									dia.inicio );
+		*cant -= 2;
+		return Fecha_Leer( fecha , tiempo );
+		
+	}
+	
+	long int dia;
+		if( !Fecha_Leer_dia( ultimo , &dia ) )
+			return 0;
+	*cant -= 1;
+	*tiempo = (int64_t)dia * FECHA_SEGUNDOS_POR_DIA;
+	if( fin )
+		*tiempo += FECHA_SEGUNDOS_POR_DIA - 1;
+	
+	return 1;
+	
+}
+
+char * Rango( char * argumento )
+{
+	
+	if( base_de_datos == NULL )
+		return "Base de datos perdida";
+	
+	vista campos[COMANDO_CAMPOS];
+	unsigned int cant = Separar_campos( argumento , campos );
+	
+	///Las fechas se leen desde el final: el nombre puede tener espacios
+	int64_t desde , hasta;
+		if( !Rango_Leer_fecha( campos , &cant , 1 , &hasta ) ||
+			!Rango_Leer_fecha( campos , &cant , 0 , &desde ) ||
+			cant < 2 )
+			return "Uso: rango no_estación variable "
+				   "dd/mm/aaaa[ hh:mm] "
+				   "dd/mm/aaaa[ hh:mm]";
+	
+	char * numero = String_Vista_copiar_en( pedido , campos[0] );
+	estacion * est = BD_Buscar_estacion( base_de_datos , numero );
+		if( est == NULL )
+			return "No existe la estación solicitada";
+	
+	int variable = Buscar_variable_en_campos( campos , 1 , cant - 1 );
+		if( variable < 0 )
+			return "No existe la variable solicitada";
+	
+	char * nombre;
+	nombre = base_de_datos->cabecera->t[BD_PRIMER_VARIABLE + variable];
+	rango_respuesta r;
+	String_Creciente_Iniciar_en( &r.texto , 4096 , pedido );
+	String_Agregar( &r.texto , "\tFecha\t\t\t" );
+	String_Agregar( &r.texto , nombre );
+	String_Agregar( &r.texto , "\n\n" );
+	r.suma = 0;
+	r.datos = 0;
+	long unsigned int filas = BD_Buscar_rango( base_de_datos ,
+											   est ,
+											   variable ,
+											   desde ,
+											   hasta ,
+											   Rango_Agregar_fila ,
+											   &r );
+	
+	///Resumen: filas, filas con dato y promedio
+	String_Agregar( &r.texto , "\n\tFilas: " );
+	String_Agregar_entero( &r.texto , filas );
+	String_Agregar( &r.texto , "\tCon dato: " );
+	String_Agregar_entero( &r.texto , r.datos );
+	String_Agregar( &r.texto , "\tPromedio: " );
+	if( r.datos == 0 )
+		String_Agregar( &r.texto , "--" );
+	else
+		String_Agregar_flotante( &r.texto , r.suma / r.datos );
+	String_Agregar_caracter( &r.texto , '\n' );
+	
+	return r.texto.texto;
+	
+}
+
+/**
+ * @brief Intervalo de 'resample' ("hora", "dia" o "mes", también en
+ * inglés)
+ *
+ * @return 1 o 0 si no es un intervalo conocido
+ */
+int Resample_Leer_intervalo( vista campo , bd_intervalo * intervalo )
+{
+	
+	if( String_Vista_igual_cadena( campo , "hora" ) ||
+		String_Vista_igual_cadena( campo , "hourly" ) )
+		*intervalo = BD_POR_HORA;
+	else if( String_Vista_igual_cadena( campo , "dia" ) ||
+			 String_Vista_igual_cadena( campo , "daily" ) )
+		*intervalo = BD_POR_DIA;
+	else if( String_Vista_igual_cadena( campo , "mes" ) ||
+			 String_Vista_igual_cadena( campo , "monthly" ) )
+		*intervalo = BD_POR_MES;
+	else
+		return 0;
+	
+	return 1;
 	
 }
 
-char * Precipitacion_FREE( char * nro_estacion , char caso )
+/**
+ * @brief Función de 'resample': 's'uma, 'p'romedio, mí'n'imo o
+ * má'x'imo ("suma" o "sum", "promedio" o "avg", "min" y "max")
+ *
+ * @return la letra o '\0' si no es una función conocida
+ */
+char Resample_Leer_funcion( vista campo )
 {
 	
-	FILE * bd = fopen( "datos_meteorologicos.CSV" , "r" );
-		if( bd == NULL )
-			return String_Crear( "Base de datos perdida" );
+	if( String_Vista_igual_cadena( campo , "suma" ) ||
+		String_Vista_igual_cadena( campo , "sum" ) )
+		return 's';
+	if( String_Vista_igual_cadena( campo , "promedio" ) ||
+		String_Vista_igual_cadena( campo , "avg" ) )
+		return 'p';
+	if( String_Vista_igual_cadena( campo , "min" ) )
+		return 'n';
+	if( String_Vista_igual_cadena( campo , "max" ) )
+		return 'x';
+	
+	return '\0';
 	
-	text * retorno = (text *)Mem_Create_text_null( 32 );
-	char cabecera[] = "\tDia\t\tAcumulado[mm]\n\n";
-	retorno->t[0] = Mem_Create_string( strlen( cabecera ) );
-	strcpy( retorno->t[0] , cabecera );
-	retorno->parts = 1;
-	unsigned int tam_retorno_cadena = strlen( cabecera ) + 1;
+}
+
+char * Resample( char * argumento )
+{
 	
-	///Recorro el archivo de datos completo (a partir de la 4ta fila)
-	File_move_to_next_ocurrence_char( bd , 13 , /*add =*/ 1 );
-	File_move_to_next_ocurrence_char( bd , 13 , /*add =*/ 1 );
-	File_move_to_next_ocurrence_char( bd , 13 , /*add =*/ 1 );
-	char ultimo_dia[3];
-	memset( ultimo_dia , '\0' , 3 );
-	float precipitacion_acum = 0;
-	int tam_bd = File_size( bd );
-	float prec_mes = 0;
-	while( ftell( bd ) != tam_bd )
+	if( base_de_datos == NULL )
+		return "Base de datos perdida";
+	
+	///Intervalo y función son los últimos campos
+	vista campos[COMANDO_CAMPOS];
+	unsigned int cant = Separar_campos( argumento , campos );
+	bd_intervalo intervalo;
+	char funcion = cant < 4 ? '\0' :
+				   Resample_Leer_funcion( campos[cant - 1] );
+		if( funcion == '\0' ||
+			!Resample_Leer_intervalo( campos[cant - 2] , &intervalo ) )
+			return "Uso: resample no_estación variable "
+				   "hora|dia|mes suma|promedio|min|max";
+	
+	char * numero = String_Vista_copiar_en( pedido , campos[0] );
+	estacion * est = BD_Buscar_estacion( base_de_datos , numero );
+		if( est == NULL )
+			return "No existe la estación solicitada";
+	
+	int variable = Buscar_variable_en_campos( campos , 1 , cant - 3 );
+		if( variable < 0 )
+			return "No existe la variable solicitada";
+	
+	bd_grupos grupos;
+	BD_Agrupar( base_de_datos , est , variable , intervalo , &grupos );
+	
+	char * nombre;
+	nombre = base_de_datos->cabecera->t[BD_PRIMER_VARIABLE + variable];
+	char * titulos[] = { "\tHora\t\t\t" , "\tDía\t\t" , "\tMes\t\t" };
+	char * funciones[] = { "Suma " , "Promedio " , "Mínimo " ,
+						   "Máximo " };
+	cadena_creciente respuesta;
+	String_Creciente_Iniciar_en( &respuesta , 128 + 32 * grupos.cant ,
+								 pedido );
+	String_Agregar( &respuesta , titulos[intervalo] );
+	String_Agregar( &respuesta , funciones[strchr( "spnx" , funcion ) -
+										   "spnx"] );
+	String_Agregar( &respuesta , nombre );
+	String_Agregar( &respuesta , "\n\n" );
+	
+	unsigned int pos;
+	for( pos = 0 ; pos < grupos.cant ; pos++ )
 	{
 		
-		///Trabajo solo con las lineas de nro_estacion
-		char * linea = File_read_until_next_ocurrence_char_FREE( bd ,
-																 13 );
-		char * linea_mem = linea;
-		char * nro_estacion_linea = String_Cortar_hasta_FREE( &linea ,
-															  "," );
-		if( strcmp( nro_estacion , nro_estacion_linea ) == 0 )
+		grupo * g = &grupos.g[pos];
+		String_Agregar_caracter( &respuesta , '\t' );
+		if( intervalo == BD_POR_HORA )
+			Fecha_Agregar_tiempo( &respuesta ,
+								  (int64_t)g->clave * 3600 );
+		else if( intervalo == BD_POR_DIA )
+			Fecha_Agregar_dia( &respuesta , g->clave );
+		else
+			Fecha_Agregar_mes( &respuesta , g->clave );
+		String_Agregar( &respuesta ,
+						intervalo == BD_POR_MES ? "\t\t" : "\t" );
+		if( g->datos == 0 )
+			String_Agregar( &respuesta , "--" );
+		else
 		{
 			
-			String_Mover_hasta( &linea , "," , /*add =*/ 1 );
-			String_Mover_hasta( &linea , "," , /*add =*/ 1 );
-			char * fechayhora = String_Cortar_hasta_FREE(&linea , ",");
-			char * fechayhora_mem = fechayhora;
-			char * dia = String_Cortar_hasta_FREE(&fechayhora , " ");
-			Mem_desassign( (void **)&fechayhora_mem );
-			String_Mover_hasta( &linea , "," , /*add =*/ 1 );
-			String_Mover_hasta( &linea , "," , /*add =*/ 1 );
-			String_Mover_hasta( &linea , "," , /*add =*/ 1 );
-			char * precipitacion_str = String_Cortar_hasta_FREE(&linea ,
-																"," );
-			float precipitacion = 0;
-			sscanf( precipitacion_str , "%f" , &precipitacion );
-			Mem_desassign( (void **)&precipitacion_str );
-			if( strcmp( ultimo_dia , "\0" ) == 0 )
-				strcpy( ultimo_dia , dia );
-			if( strcmp( dia , ultimo_dia ) == 0 )
-				precipitacion_acum += precipitacion;
-			else
-			{
-				
-				prec_mes += precipitacion_acum;
-				char * prec_acum_str;
-				prec_acum_str = String_Flotante_a_cadena_FREE(
-												precipitacion_acum );
-				precipitacion_acum = precipitacion;
-				char * retorno_fila;
-				retorno_fila = Mem_assign( strlen( prec_acum_str )
-											+ strlen( dia )
-											+ 2 );
-				retorno_fila[0] = '\0';
-				strcat( retorno_fila , "\t" );
-				strcat( retorno_fila , ultimo_dia );
-				strcat( retorno_fila , "\t" );
-				strcat( retorno_fila , prec_acum_str );
-				strcat( retorno_fila , "\n" );
-				Mem_desassign( (void **)&prec_acum_str );
-				retorno->t[retorno->parts++] = retorno_fila;
-				tam_retorno_cadena += strlen( retorno_fila ) + 1;
-				
-				strcpy( ultimo_dia , dia );
-				
-			}
+			float valor = funcion == 's' ? g->suma :
+						  funcion == 'p' ? g->suma / g->datos :
+						  funcion == 'n' ? g->minimo : g->maximo;
+			String_Agregar_flotante( &respuesta , valor );
+			
+		}
+		String_Agregar_caracter( &respuesta , '\n' );
+		
+	}
+	String_Agregar( &respuesta , "\n\tGrupos: " );
+	String_Agregar_entero( &respuesta , grupos.cant );
+	String_Agregar_caracter( &respuesta , '\n' );
+	Mem_desassign( (void **)&grupos.g );
+	
+	return respuesta.texto;
+	
+}
+
+/**
+ * @brief Comando con sus campos separados por un solo espacio: así
+ * las variantes de un mismo comando comparten la respuesta guardada
+ */
+char * Normalizar_comando( char * comando )
+{
+	
+	cadena_creciente normalizado;
+	String_Creciente_Iniciar_en( &normalizado , strlen( comando ) ,
+								 pedido );
+	vista resto = String_Vista_de_cadena( comando );
+	vista campo;
+	while( String_Siguiente_campo( &resto , " " , &campo ) )
+		if( campo.largo > 0 )
+		{
 			
-			Mem_desassign( (void **)&dia );
+			if( normalizado.largo > 0 )
+				String_Agregar_caracter( &normalizado , ' ' );
+			String_Agregar_vista( &normalizado , campo );
 			
-		}//if
+		}
+	
+	return normalizado.texto;
+	
+}
+
+char * Comando
+( char comando[] , int sockfdUDP , struct sockaddr_in addrUDP )
+{
+	
+	///'descargar' y 'desconectar' actúan además de responder; descargar
+	///toma el cerrojo de la base por su cuenta
+	if( strncmp( comando , "descargar " , 10 ) == 0 ||
+		base_de_datos == NULL ||
+		strcmp( comando , "desconectar" ) == 0 )
+	{
 		
-		Mem_desassign( (void **)&linea_mem );
-		Mem_desassign( (void **)&nro_estacion_linea );
+		return Ejecutar_comando( comando , sockfdUDP , addrUDP );
 		
 	}
 	
-	text * rtrn;
-	switch( caso )
+	///Lo guardado vale mientras no cambie la versión de la base. Dos
+	///pedidos iguales a la vez pueden calcularla ambos
+	pthread_mutex_lock( &respuestas_cerrojo );
+	char * respuesta = Cache_Buscar_en( &respuestas , comando ,
+										base_de_datos->version ,
+										pedido );
+	pthread_mutex_unlock( &respuestas_cerrojo );
+	if( respuesta == NULL )
 	{
 		
-		case 'd':
-			return Mem_Copy_text_into_string_and_delete_text(&retorno);
-			
-		case 'm':
-			rtrn = Mem_Create_text_null( 6 );
-			rtrn->t[0] = String_Crear( "\tMes\t\tAcumulado[mm]\n\n" );
-			rtrn->t[1] = String_Crear( "\t" );
-			char * mes = retorno->t[1];
-			String_Mover_hasta( &mes , "/" , 1 );
-			rtrn->t[2] = String_Cortar_hasta_FREE( &mes , "\t" );
-			rtrn->t[3] = String_Crear( "\t\t" );
-			rtrn->t[4] = String_Flotante_a_cadena_FREE( prec_mes );
-			rtrn->t[5] = String_Crear( "\n" );
-			Mem_Delete_text( &retorno );
-			return Mem_Copy_text_into_string_and_delete_text( &rtrn );
-			
+		respuesta = Ejecutar_comando( comando , sockfdUDP , addrUDP );
+		pthread_mutex_lock( &respuestas_cerrojo );
+		Cache_Guardar( &respuestas , comando , respuesta ,
+					   base_de_datos->version );
+		pthread_mutex_unlock( &respuestas_cerrojo );
 		
 	}
 	
-	return NULL;
+	return respuesta;
 	
 }
 
-char * Comando_FREE
+char * Ejecutar_comando
 ( char comando[] , int sockfdUDP , struct sockaddr_in addrUDP )
 {
 	
-	char * cmd_cut = comando;
-	char * orden;
-	switch( cmd_cut[0] )
+	///Separo la orden del argumento sin copiarlos
+	vista resto = String_Vista_de_cadena( comando );
+	vista orden;
+		if( !String_Siguiente_campo( &resto , " " , &orden ) )
+			return "Comando no reconocido";
+	char * argumento = resto.inicio;
+	switch( comando[0] )
 	{
 		
 		case 'd':
 			
-			if( strcmp( cmd_cut , "desconectar" ) == 0 )
-				return String_Crear( "Desconexión recibida." );
+			if( strcmp( comando , "desconectar" ) == 0 )
+				return "Desconexión recibida.";
 			
 			///Comprobar 'descargar' o 'diario_precipitacion'
-			orden = String_Cortar_hasta_FREE( &cmd_cut , " " );
-				if( orden == NULL )
-					break;
-				if( cmd_cut == NULL )
+				if( argumento == NULL )
 					break;
-			if( strcmp( orden , "descargar" ) == 0 )
-			{
-				
-				Mem_desassign( (void **)&orden );
-				return String_Crear( Descargar( cmd_cut ,
-												sockfdUDP ,
-												addrUDP )
-									);
-			}
-			if( strcmp( orden , "diario_precipitacion" ) == 0 )
-			{
-				
-				Mem_desassign( (void **)&orden );
-				char * rtrn = Precipitacion_FREE( cmd_cut , 'd' );
-				return rtrn;
-				
-			}
+			if( String_Vista_igual_cadena( orden , "descargar" ) )
+				return Descargar( argumento , sockfdUDP , addrUDP );
+			if( String_Vista_igual_cadena( orden ,
+										   "diario_precipitacion" ) )
+				return Precipitacion( argumento , 'd' );
 			break;
 			
+		case 'e':
+		
+				if( argumento == NULL )
+					break;
+			if( String_Vista_igual_cadena( orden , "estadisticas" ) )
+				return Estadisticas( argumento );
+			break;
+		
 		case 'l':
 			
-			if( strcmp( cmd_cut , "listar" ) == 0 )
-				return Listar_FREE( );
+			if( strcmp( comando , "listar" ) == 0 )
+				return Listar( );
 			break;
 			
 		case 'm':
 			
-			orden = String_Cortar_hasta_FREE( &cmd_cut , " " );
-				if( orden == NULL )
-					break;
-				if( cmd_cut == NULL )
+				if( argumento == NULL )
 					break;
-			if( strcmp( orden , "mensual_precipitacion" ) == 0 )
-				return Precipitacion_FREE( cmd_cut , 'm' );
+			if( String_Vista_igual_cadena( orden ,
+										   "mensual_precipitacion" ) )
+				return Precipitacion( argumento , 'm' );
 			break;
 			
+		case 'p':
+		
+				if( argumento == NULL )
+					break;
+			if( String_Vista_igual_cadena( orden , "promedio" ) )
+				return Promedio( argumento );
+			if( String_Vista_igual_cadena( orden , "percentil" ) )
+				return Percentil( argumento );
+			break;
+		
+		case 'r':
+		
+				if( argumento == NULL )
+					break;
+			if( String_Vista_igual_cadena( orden , "rango" ) )
+				return Rango( argumento );
+			if( String_Vista_igual_cadena( orden , "resample" ) )
+				return Resample( argumento );
+			break;
+		
 		
 	}
 	
-	return String_Crear( "Comando no reconocido" );
+	return "Comando no reconocido";
 	
 }